@@ -1,8 +1,10 @@
 #pragma once
 #include "core/context.h"
 #include "view/view.h"
+#include "graphics/glyph_warmer.h"
 #include <memory>
 #include <any>
+#include <future>
 #include <map>
 
 class Activity : public Context {
@@ -52,6 +54,10 @@ public:
     
     void finish();
     
+    // 在onCreate或onResume中调用，在工作线程上预先光栅化界面文本
+    // 再次调用会先等待上一次预热结束
+    void warmGlyphCache(std::vector<GlyphWarmer::Item> items);
+    
     // 获取启动此Activity时传递的数据
     template<typename T>
     T getExtra(const std::string& key, const T& defaultValue = T()) const {
@@ -84,4 +90,5 @@ private:
     View* contentView = nullptr;
     bool isStateSaved = false;
     std::map<std::string, std::any> extras;        // 启动时携带的数据
+    std::future<void> glyphWarmup;                 // 析构时等待预热完成
 }; 
\ No newline at end of file
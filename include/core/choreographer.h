@@ -20,13 +20,17 @@ public:
     // 设置 Surface 用于 VSync
     void setSurface(Surface* surface);
     
-    // 控制
+    // 控制，stop时丢弃尚未执行的帧回调
     bool start();
     void stop();
+    bool isRunning() const { return running.load(std::memory_order_relaxed); }
     
     // 设置后备帧率（VSync 不可用时使用）
     void setFallbackFrameRate(int fps);
 
+    // 预计下一帧开始的steady_clock时间（纳秒），未运行时返回0
+    int64_t getNextFrameTimeNanos() const { return nextFrameTimeNanos.load(std::memory_order_relaxed); }
+
 private:
     Choreographer();
     ~Choreographer() = default;
@@ -39,6 +43,7 @@ private:
     std::queue<FrameCallback> frameCallbacks;
     
     int64_t fallbackFrameIntervalNanos{16666667}; // 默认 60fps
+    std::atomic<int64_t> nextFrameTimeNanos{0};
     
     void vsyncLoop();
     void executeCallbacks(int64_t frameTimeNanos);
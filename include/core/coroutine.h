@@ -0,0 +1,161 @@
+#pragma once
+#include "core/handler.h"
+#include "core/thread_pool.h"
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// 协程帧按大小分档缓存在线程本地的空闲链表中，反复启动协程时不走全局堆
+void* allocateCoroutineFrame(size_t size);
+void freeCoroutineFrame(void* frame, size_t size);
+
+// 在Looper线程上运行的协程，创建后立即执行，结束时自动释放帧
+// 参数中第一个Handler（引用或指针，成员函数时包括*this）为协程的所有者：
+// 所有者析构后挂起中的协程不再恢复，而是直接销毁帧，局部对象正常析构
+// 挂起后在协程当前所在的Handler线程上恢复，初始为所有者，resumeOn可切换
+class AsyncTask {
+public:
+    struct promise_type {
+        std::shared_ptr<HandlerAnchor> owner;
+        std::shared_ptr<HandlerAnchor> current;
+
+        template <typename... Args>
+        explicit promise_type(Args&... args) {
+            (bindOwner(args), ...);
+            current = owner;
+        }
+
+        static void* operator new(size_t size) { return allocateCoroutineFrame(size); }
+        static void operator delete(void* frame, size_t size) { freeCoroutineFrame(frame, size); }
+
+        AsyncTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        // 记录日志后结束协程，异常不会传播到Looper
+        void unhandled_exception() noexcept;
+
+    private:
+        template <typename T>
+        void bindOwner(T& arg) {
+            if (owner) {
+                return;
+            }
+            if constexpr (std::is_base_of_v<Handler, T>) {
+                owner = arg.getAnchor();
+            } else if constexpr (std::is_pointer_v<T> &&
+                                 std::is_base_of_v<Handler, std::remove_pointer_t<T>>) {
+                if (arg) {
+                    owner = arg->getAnchor();
+                }
+            }
+        }
+    };
+};
+
+using AsyncHandle = std::coroutine_handle<AsyncTask::promise_type>;
+
+// 投递到协程当前所在的Handler上恢复；Handler已析构或没有Handler时销毁协程
+void scheduleResume(AsyncHandle handle, int64_t delayMillis = 0,
+                    MessagePriority priority = MessagePriority::Default);
+
+// co_await handler.resumeOn()
+struct HandlerResumeAwaiter {
+    std::shared_ptr<HandlerAnchor> target;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(AsyncHandle handle);
+    void await_resume() const noexcept {}
+};
+
+inline HandlerResumeAwaiter Handler::resumeOn() {
+    return HandlerResumeAwaiter{anchor};
+}
+
+// co_await delay(ms)，delay(0)让出一次，排到已到期的消息之后
+struct DelayAwaiter {
+    int64_t delayMillis;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(AsyncHandle handle) { scheduleResume(handle, delayMillis); }
+    void await_resume() const noexcept {}
+};
+
+inline DelayAwaiter delay(int64_t delayMillis) {
+    return DelayAwaiter{delayMillis};
+}
+
+// co_await nextFrame()，返回帧时间（纳秒）
+// Choreographer没有运行或在此期间停止时协程被取消，与所有者析构时相同
+struct FrameAwaiter {
+    int64_t frameTimeNanos = 0;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(AsyncHandle handle);
+    int64_t await_resume() const noexcept { return frameTimeNanos; }
+};
+
+inline FrameAwaiter nextFrame() {
+    return FrameAwaiter{};
+}
+
+// co_await runInPool(fn)：fn在线程池上执行，完成后回到协程当前的Handler线程，返回fn的结果
+// fn抛出的异常在co_await处重新抛出
+template <typename F>
+class PoolTaskAwaiter {
+public:
+    using Result = std::invoke_result_t<F&>;
+
+    PoolTaskAwaiter(F fn, ThreadPool& pool) : fn(std::move(fn)), pool(pool) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(AsyncHandle handle) {
+        // 挂起期间awaiter保存在协程帧中，地址不变
+        pool.submit([this, handle]() {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    fn();
+                } else if constexpr (std::is_reference_v<Result>) {
+                    Result&& value = fn();
+                    result.emplace(std::addressof(value));
+                } else {
+                    result.emplace(fn());
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            scheduleResume(handle);
+        });
+    }
+
+    Result await_resume() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if constexpr (std::is_reference_v<Result>) {
+            return static_cast<Result>(**result);
+        } else if constexpr (!std::is_void_v<Result>) {
+            return std::move(*result);
+        }
+    }
+
+private:
+    // optional不能保存引用，引用结果按指针保存
+    using Storage = std::conditional_t<
+        std::is_void_v<Result>, char,
+        std::conditional_t<std::is_reference_v<Result>, std::remove_reference_t<Result>*, Result>>;
+
+    F fn;
+    ThreadPool& pool;
+    std::optional<Storage> result;
+    std::exception_ptr error;
+};
+
+template <typename F>
+PoolTaskAwaiter<std::decay_t<F>> runInPool(F&& fn, ThreadPool& pool = ThreadPool::getInstance()) {
+    return PoolTaskAwaiter<std::decay_t<F>>(std::forward<F>(fn), pool);
+}
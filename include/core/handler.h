@@ -1,14 +1,35 @@
 #pragma once
 #include "core/looper.h"
 #include "core/message.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class Handler;
+struct HandlerResumeAwaiter;
+
+// 在其它线程上持有，用于向可能已经析构的Handler投递消息
+// Handler析构时先把handler置空，之后的投递直接失败，回调随之销毁
+struct HandlerAnchor {
+    std::mutex mutex;
+    Handler* handler = nullptr;
+
+    bool post(InlineCallback callback, int64_t delayMillis = 0,
+              MessagePriority priority = MessagePriority::Default);
+    bool isAlive();
+};
 
 class Handler {
 public:
-    explicit Handler(Looper* looper) {
+    // async为true时，经此Handler发送的消息都是异步消息，不受同步屏障阻挡
+    explicit Handler(Looper* looper, bool async = false) {
         if (!looper) {
             throw std::invalid_argument("Null looper provided to Handler constructor");
         }
         this->looper = looper;
+        this->asynchronous = async;
+        anchor = std::make_shared<HandlerAnchor>();
+        anchor->handler = this;
     }
     virtual ~Handler();
     
@@ -27,16 +48,48 @@ public:
     // 发送延迟空消息
     void sendEmptyMessageDelayed(int what, int64_t delayMillis);
     
-    // 发送Runnable
-    void post(std::function<void()> r);
+    // 发送Runnable，返回的令牌可用于cancel
+    MessageToken post(InlineCallback r);
+    
+    // 指定优先级发送Runnable；输入和帧通常同时设为异步消息，不受同步屏障阻挡
+    MessageToken post(InlineCallback r, MessagePriority priority, bool async = false);
     
     // 发送延迟Runnable
-    void postDelayed(std::function<void()> r, int64_t delayMillis);
+    MessageToken postDelayed(InlineCallback r, int64_t delayMillis);
+
+    // 取消尚未执行的消息，成功时返回true
+    bool cancel(MessageToken token);
+
+    // 删除本Handler尚未执行的、指定what的消息
+    void removeMessages(int what);
     
     virtual void handleMessage(Message& message);
     
     friend class UIThread;
     
+    bool isAsynchronous() const { return asynchronous; }
+
+    // 消息的优先级为Default时使用Handler的优先级
+    void setPriority(MessagePriority priority) { this->priority = priority; }
+    MessagePriority getPriority() const { return priority; }
+
+    const std::shared_ptr<HandlerAnchor>& getAnchor() const { return anchor; }
+
+    // co_await handler.resumeOn() 把协程切换到本Handler所在的线程继续执行，见core/coroutine.h
+    HandlerResumeAwaiter resumeOn();
+    
 protected:
     Looper* looper;
+    bool asynchronous = false;
+    MessagePriority priority = MessagePriority::Normal;
+
+private:
+    friend class MessageQueue;
+
+    // 尚未执行的消息按what串成链表，由MessageQueue在持有其mutex时维护
+    // 链表清空后保留表项，反复投递同一what时不再分配节点
+    std::unordered_map<int, Message*> pendingMessages;
+    std::shared_ptr<HandlerAnchor> anchor;
+
+    MessageToken enqueueMessage(Message* msg);
 }; 
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+
+// 只可移动的无参回调，kInlineSize以内且移动不抛异常的可调用对象直接存放在内部缓冲区
+// 投递小lambda时不分配内存；更大的对象退回到堆上
+class InlineCallback {
+public:
+    static constexpr size_t kInlineSize = 48;
+
+    InlineCallback() noexcept = default;
+    InlineCallback(std::nullptr_t) noexcept {}
+
+    template <typename F,
+              typename D = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<D, InlineCallback> &&
+                                          std::is_invocable_r_v<void, D&>>>
+    InlineCallback(F&& f) {
+        if constexpr (std::is_pointer_v<D> || std::is_same_v<D, std::function<void()>>) {
+            if (!f) {
+                return;
+            }
+        }
+        if constexpr (fitsInline<D>()) {
+            ::new (static_cast<void*>(buffer)) D(std::forward<F>(f));
+            ops = &kInlineOps<D>;
+        } else {
+            ::new (static_cast<void*>(buffer)) D*(new D(std::forward<F>(f)));
+            ops = &kHeapOps<D>;
+        }
+    }
+
+    InlineCallback(InlineCallback&& other) noexcept {
+        moveFrom(other);
+    }
+
+    InlineCallback& operator=(InlineCallback&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineCallback& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    InlineCallback(const InlineCallback&) = delete;
+    InlineCallback& operator=(const InlineCallback&) = delete;
+
+    ~InlineCallback() { reset(); }
+
+    explicit operator bool() const noexcept { return ops != nullptr; }
+
+    void operator()() { ops->invoke(buffer); }
+
+    // 保存的可调用对象的类型，为空时返回nullptr
+    const std::type_info* targetType() const noexcept { return ops ? ops->type : nullptr; }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(buffer);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* dst, void* src) noexcept;  // 移动到dst并析构src
+        void (*destroy)(void* storage) noexcept;
+        const std::type_info* type;
+    };
+
+    template <typename D>
+    static constexpr bool fitsInline() {
+        return sizeof(D) <= kInlineSize && alignof(D) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<D>;
+    }
+
+    template <typename D>
+    static constexpr Ops kInlineOps = {
+        [](void* storage) { (*static_cast<D*>(storage))(); },
+        [](void* dst, void* src) noexcept {
+            D* source = static_cast<D*>(src);
+            ::new (dst) D(std::move(*source));
+            source->~D();
+        },
+        [](void* storage) noexcept { static_cast<D*>(storage)->~D(); },
+        &typeid(D)
+    };
+
+    template <typename D>
+    static constexpr Ops kHeapOps = {
+        [](void* storage) { (**static_cast<D**>(storage))(); },
+        [](void* dst, void* src) noexcept { ::new (dst) D*(*static_cast<D**>(src)); },
+        [](void* storage) noexcept { delete *static_cast<D**>(storage); },
+        &typeid(D)
+    };
+
+    void moveFrom(InlineCallback& other) noexcept {
+        if (other.ops) {
+            other.ops->relocate(buffer, other.buffer);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer[kInlineSize];
+    const Ops* ops = nullptr;
+};
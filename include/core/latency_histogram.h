@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+// 按2的幂分桶的耗时直方图，桶0为不足1微秒，桶i为[2^(i-1), 2^i)微秒
+// 单线程写入、任意线程读取，计数用relaxed原子变量
+class LatencyHistogram {
+public:
+    static constexpr int kBuckets = 32;
+
+    void record(int64_t nanos) {
+        uint64_t micros = nanos > 0 ? static_cast<uint64_t>(nanos) / 1000 : 0;
+        int bucket = std::min<int>(std::bit_width(micros), kBuckets - 1);
+        // 只有一个写入者，不需要带锁的读改写
+        buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+    }
+
+    uint64_t getBucketCount(int bucket) const {
+        return buckets[bucket].load(std::memory_order_relaxed);
+    }
+
+    // 桶的上界（微秒）
+    static uint64_t getBucketLimitMicros(int bucket) {
+        return uint64_t(1) << bucket;
+    }
+
+    uint64_t getCount() const {
+        uint64_t total = 0;
+        for (const auto& bucket : buckets) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // 不低于fraction比例样本的桶上界（微秒），没有样本时返回0
+    uint64_t getPercentileMicros(double fraction) const {
+        uint64_t total = getCount();
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(fraction * total);
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += getBucketCount(i);
+            if (seen > target || seen == total) {
+                return getBucketLimitMicros(i);
+            }
+        }
+        return getBucketLimitMicros(kBuckets - 1);
+    }
+
+    void reset() {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<uint64_t> buckets[kBuckets] = {};
+};
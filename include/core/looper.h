@@ -10,6 +10,13 @@ public:
     static void quit();
     
     MessageQueue* getQueue() { return queue; }
+
+    // 在本Looper线程上监听文件描述符（socket、pipe、timerfd等），events为Poller::Event组合
+    // 回调返回false时注销；仅Linux支持，其它平台返回false
+    bool addFd(int fd, uint32_t events, Poller::FdCallback callback) {
+        return queue->addFd(fd, events, std::move(callback));
+    }
+    bool removeFd(int fd) { return queue->removeFd(fd); }
     ~Looper();
     
 private:
@@ -0,0 +1,84 @@
+#pragma once
+#include "core/latency_histogram.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <typeinfo>
+
+// 编译时关闭：-DLOOPER_STATS_ENABLED=0（CMake选项LOOPER_STATS），关闭后不记录也不多读时钟
+#ifndef LOOPER_STATS_ENABLED
+#define LOOPER_STATS_ENABLED 1
+#endif
+
+class Message;
+
+// 同一Handler类型、回调类型和what的消息汇总在一起
+struct MessageStats {
+    const std::type_info* handlerType = nullptr;   // 直接投递到队列的Runnable为nullptr
+    const std::type_info* callbackType = nullptr;  // 不是Runnable时为nullptr
+    int what = 0;
+    LatencyHistogram queueDelay;  // 从到期到开始执行
+    LatencyHistogram runTime;
+    std::atomic<int64_t> maxRunNanos{0};
+};
+
+struct SlowMessageInfo {
+    const std::type_info* handlerType;
+    const std::type_info* callbackType;
+    int what;
+    int64_t queueDelayNanos;
+    int64_t runNanos;
+};
+
+// 一个Looper的消息耗时统计，由Looper线程写入，任意线程读取
+// 条目放在固定大小的开放寻址表中，插入后不再移动，记录时不加锁也不分配内存
+class LooperStats {
+public:
+    static constexpr size_t kMaxEntries = 256;  // 超出的种类汇总到overflow
+    using SlowMessageCallback = std::function<void(const SlowMessageInfo&)>;
+
+    // 在Looper线程上、消息执行前取得对应的条目，执行中target可能被析构
+    MessageStats& statsFor(const Message& msg);
+    // 在Looper线程上、消息执行完之后调用
+    void record(MessageStats& stats, int64_t queueDelayNanos, int64_t runNanos);
+
+    // 执行时间超过thresholdNanos的消息在Looper线程上回调，callback为空时关闭
+    void setSlowMessageCallback(int64_t thresholdNanos, SlowMessageCallback callback);
+
+    // 遍历已有的条目，可在任意线程调用
+    template <typename F>
+    void forEach(F&& fn) const {
+        for (const Entry& entry : entries) {
+            if (entry.used.load(std::memory_order_acquire)) {
+                fn(entry.stats);
+            }
+        }
+        if (overflow.runTime.getCount() > 0) {
+            fn(overflow);
+        }
+    }
+
+    // 清零计数，已有的条目保留
+    void reset();
+
+    // 按次数输出各条目的排队和执行耗时
+    void dump() const;
+
+private:
+    struct Entry {
+        std::atomic<bool> used{false};
+        MessageStats stats;
+    };
+
+    Entry entries[kMaxEntries];
+    MessageStats overflow;
+    std::atomic<int64_t> slowThresholdNanos{INT64_MAX};
+    std::mutex slowMutex;
+    SlowMessageCallback slowCallback;
+
+    MessageStats& findStats(const std::type_info* handlerType,
+                            const std::type_info* callbackType, int what);
+    void reportSlowMessage(const MessageStats& stats, int64_t queueDelayNanos, int64_t runNanos);
+};
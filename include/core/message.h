@@ -1,13 +1,31 @@
 #pragma once
 #include <functional>
+#include <typeinfo>
+#include <atomic>
 #include <chrono>
 #include <queue>
 #include <vector>
 #include <mutex>
 #include <condition_variable>
+#include "core/inline_callback.h"
+#include "core/latency_histogram.h"
+#include "core/looper_stats.h"
+#include "core/poller.h"
+#include "core/timing_wheel.h"
 
 class Handler;
 
+// 消息优先级，已到期的消息按此顺序执行
+enum class MessagePriority : uint8_t {
+    Input,       // 输入事件
+    Frame,       // 动画、遍历和帧绘制
+    Normal,      // 普通任务
+    Background,  // 可以推迟的后台任务
+    Default      // 未指定：使用Handler的优先级，直接投递到队列时为Normal；不对应通道
+};
+
+constexpr int kMessagePriorityCount = 4;  // 通道数，不含Default
+
 // 消息定义
 class Message {
 public:
@@ -15,9 +33,21 @@ public:
     int arg1 = 0;
     int arg2 = 0;
     void* data = nullptr;
-    std::function<void()> callback;
+    InlineCallback callback;
     int64_t when = 0;
     Handler* target = nullptr;
+    bool asynchronous = false;  // 异步消息不受同步屏障阻挡，用于输入和帧
+    MessagePriority priority = MessagePriority::Default;
+    std::atomic<Message*> next{nullptr};  // 收件箱链表，由MessageInbox维护
+    uint64_t sequence = 0;                // 进入定时堆的顺序，同一时间的消息按此先后执行
+    std::atomic<uint32_t> generation{0};  // 每次离开队列加一，令牌中的值不同即已失效
+    bool cancelled = false;               // 已取消但仍留在就绪堆或收件箱中，取出时回收
+    bool indexed = false;                 // 已挂入Handler的待处理链表，仍在收件箱中时为false
+    Message* handlerPrev = nullptr;       // 同一Handler、同一what的待处理消息链表
+    Message* handlerNext = nullptr;
+    Message* wheelPrev = nullptr;         // 时间轮槽内的双向链表，由TimingWheel维护
+    Message* wheelNext = nullptr;
+    int wheelSlot = -1;                   // 不在时间轮中时为-1
     
     void reset() {
         what = 0;
@@ -27,51 +57,252 @@ public:
         callback = nullptr;
         when = 0;
         target = nullptr;
+        asynchronous = false;
+        priority = MessagePriority::Default;
+        cancelled = false;
+        indexed = false;
+        sequence = 0;
     }
 
     static Message* obtain();
     static void recycle(Message* msg);
+    // 把本线程缓存的消息还给全局池；消息内存不释放，过期的令牌始终可以安全检查
     static void clearPool();
     // 在 Message 类中添加
 
     ~Message() = default;
 };
 
+// 投递后返回的令牌，用于取消尚未执行的消息；消息执行或取消后令牌自动失效
+struct MessageToken {
+    Message* message = nullptr;
+    uint32_t generation = 0;
+
+    explicit operator bool() const { return message != nullptr; }
+};
+
+// 多生产者单消费者的无锁收件箱（Vyukov侵入式队列），以Message::next串联
+// 生产者只做一次原子交换，不加锁也不重试；消费端同一时刻只能有一个线程
+class MessageInbox {
+public:
+    MessageInbox() : head(&stub), tail(&stub) {}
+    MessageInbox(const MessageInbox&) = delete;
+    MessageInbox& operator=(const MessageInbox&) = delete;
+
+    // 任意线程调用，无等待
+    void push(Message* msg) {
+        msg->next.store(nullptr, std::memory_order_relaxed);
+        // seq_cst与MessageQueue::sleeping配合，保证消费者入睡前能看到新消息
+        Message* prev = head.exchange(msg, std::memory_order_seq_cst);
+        // 交换与链接之间消费者会看到断开的链表，pop返回nullptr直到链接完成
+        prev->next.store(msg, std::memory_order_release);
+    }
+
+    // 仅消费者调用，按入队顺序返回；为空或生产者尚未完成链接时返回nullptr
+    Message* pop() {
+        Message* first = tail;
+        Message* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (!next) {
+                return nullptr;
+            }
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        // first是最后一个节点，重新挂上stub后才能把它取走
+        push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+    // 任意线程调用，最后入队的节点，只用于判断期间是否有新消息
+    const Message* peekHead() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    // 仅消费者调用；有生产者正在链接时也返回false，调用方不应据此睡眠
+    bool isEmpty() const {
+        return tail == &stub && head.load(std::memory_order_seq_cst) == &stub;
+    }
+
+private:
+    std::atomic<Message*> head;  // 生产者端，最后入队的节点
+    Message* tail;               // 消费者端，下一个出队的节点
+    Message stub;
+};
+
+// 空闲处理可以使用的时间，到期后应尽快返回IdleResult::Yield
+// 空闲期间有新消息投递时也视为时间用完，让消息先执行
+struct IdleDeadline {
+    int64_t deadlineNanos = 0;  // steady_clock时间
+    const MessageInbox* inbox = nullptr;
+    const Message* inboxHead = nullptr;  // 开始空闲处理时收件箱的最后一个节点
+
+    int64_t timeRemainingNanos() const {
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return deadlineNanos - now;
+    }
+    bool hasPendingMessages() const { return inbox && inbox->peekHead() != inboxHead; }
+    bool hasTimeRemaining() const { return timeRemainingNanos() > 0 && !hasPendingMessages(); }
+};
+
+enum class IdleResult {
+    Remove,  // 不再需要，移除
+    Keep,    // 暂无工作，下次队列空闲时再调用
+    Yield    // 时间用完但工作未完成，下一段空闲时间继续
+};
+
 // 消息队列定义
+// 生产者只向无锁收件箱追加消息，由消费端（通常是Looper线程）转入私有结构：
+// 已到期的进就绪堆，未到期的进时间轮
+// mutex只保护这些私有结构和等待条件，投递消息不需要获取
 class MessageQueue {
 public:
+    // 旧式空闲处理，返回false时移除
     using IdleHandler = std::function<bool()>;
+    // 带截止时间的空闲处理，截止时间取下一帧、下一个定时消息和单次预算中最早的
+    using DeadlineIdleHandler = std::function<IdleResult(const IdleDeadline&)>;
+
+    MessageQueue();
     
-    void post(std::function<void()> message);
-    void postDelayed(std::function<void()> message, int64_t delayMillis);
+    MessageToken post(InlineCallback message);
+    MessageToken postDelayed(InlineCallback message, int64_t delayMillis);
     void processNextMessage();
     
-    void enqueueMessage(Message* msg, Handler* handler);
+    MessageToken enqueueMessage(Message* msg, Handler* handler);
     void addIdleHandler(IdleHandler handler);
+    void addIdleHandler(DeadlineIdleHandler handler);
     void removeIdleHandler(const IdleHandler& handler);
+
+    // 返回下一帧开始的steady_clock时间（纳秒），未知时返回0；在Looper线程上调用
+    void setFrameTimeProvider(std::function<int64_t()> provider);
+    // 同步屏障：屏障之后到期的同步消息暂停执行，直到屏障被移除，异步消息不受影响
+    // 用于让遍历和帧绘制越过积压的普通任务；返回用于移除的令牌
     int postSyncBarrier();
     void removeSyncBarrier(int token);
+    // 取消只标记墓碑，不重排队列；按Handler或what删除只遍历该Handler自己的待处理消息
+    bool cancel(MessageToken token);
     void removeMessagesForHandler(Handler* handler);
+    void removeMessages(Handler* handler, int what);
     void quit();
     void removeAllMessages();
 
+    // 监听文件描述符，就绪时在Looper线程上执行回调，与消息共用一次等待
+    bool addFd(int fd, uint32_t events, Poller::FdCallback callback);
+    bool removeFd(int fd);
+
+    // 各优先级从到期到开始执行的等待时间
+    const LatencyHistogram& getQueueLatency(MessagePriority priority) const {
+        return lanes[static_cast<int>(priority)].latency;
+    }
+
+#if LOOPER_STATS_ENABLED
+    // 按Handler类型、回调类型和what汇总的排队与执行耗时
+    LooperStats& getStats() { return stats; }
+#endif
+
 private:
     struct MessageComparer {
         bool operator()(Message* a, Message* b) {
-            return a->when > b->when;
+            if (a->when != b->when) {
+                return a->when > b->when;
+            }
+            return a->sequence > b->sequence;
         }
     };
     
-    std::priority_queue<
+    using MessageHeap = std::priority_queue<
         Message*,
         std::vector<Message*>,
         MessageComparer
-    > messageQueue;
+    >;
+
+    struct SyncBarrier {
+        int token;
+        int64_t when;
+        uint64_t sequence;
+    };
+
+    // 每个优先级一条通道，已到期的消息按when和sequence排序，同步与异步分开存放
+    struct Lane {
+        MessageHeap sync;
+        MessageHeap async;
+        LatencyHistogram latency;
+    };
+
+    Lane lanes[kMessagePriorityCount];
+    bool lastPickStarved = false;  // 上一条是否因防饿死而选中
+    std::vector<SyncBarrier> barriers;
+    int nextBarrierToken = 0;
+
+    TimingWheel timers;
+    std::vector<Message*> expiredTimers;  // advanceTimers的临时缓冲
+    // 被移除消息的回调，解锁后再销毁：析构时可能销毁协程帧，帧中的对象可能再访问队列
+    std::vector<InlineCallback> droppedCallbacks;
+
+    MessageInbox inbox;
+    uint64_t nextSequence = 0;
+
+#if LOOPER_STATS_ENABLED
+    LooperStats stats;
+#endif
     
-    std::vector<IdleHandler> idleHandlers;
-    std::mutex mutex;
-    std::condition_variable messageAvailable;
-    bool quitting = false;
+    struct IdleEntry {
+        DeadlineIdleHandler handler;
+        const std::type_info* type;  // 原始回调的类型，供removeIdleHandler比较
+    };
+
+    std::vector<IdleEntry> idleHandlers;
+    size_t idleCursor = 0;  // 轮转起点，只在Looper线程上访问
+    int64_t idleResumeNanos = 0;  // 空闲时间用完后到这个时刻才继续，只在Looper线程上访问
+    std::mutex idleMutex;
+    // 一轮空闲处理执行期间的移除请求，由idleMutex保护；idleRemovalPending供Looper线程不加锁检查
+    bool runningIdleHandlers = false;
+    std::vector<const std::type_info*> pendingIdleRemovals;
+    std::atomic<bool> idleRemovalPending{false};
+    std::function<int64_t()> frameTimeProvider;
+    std::mutex mutex;  // 持有者即收件箱的唯一消费者
+    Poller poller{mutex};
+    int64_t lastFdPollNanos = 0;  // 只在Looper线程上访问
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> quitting{false};
+
+    MessageToken pushMessage(Message* msg);
+    void wake();
+    // 以下需持有mutex
+    void drainInbox();
+    void advanceTimers(int64_t now);
+    void pushReady(Message* msg);
+    Message* nextReadyMessage(int64_t now);
+    Message* peekLane(Lane& lane, const SyncBarrier* barrier);
+    bool hasPendingMessages() const;
+    void indexMessage(Message* msg);
+    void unindexMessage(Message* msg);
+    void dropMessage(Message* msg);
+    void dropMessageList(Message* head);
+    void clearMessages();
+    // 解锁后销毁droppedCallbacks中的回调，返回时lock已释放
+    void destroyDroppedCallbacks(std::unique_lock<std::mutex>& lock);
+    void waitForMessages(std::unique_lock<std::mutex>& lock, int64_t when);
+    int64_t getIdleDeadline(int64_t now);
+    bool hasIdleHandlers();
+    bool hasReadyMessages() const;
+    // 在锁外调用，返回是否还有没做完的工作
+    bool runIdleHandlers(const IdleDeadline& idleDeadline);
+    void applyIdleRemovals(const std::vector<IdleEntry>& entries, std::vector<bool>& removed);
 
     static int64_t getCurrentTimeNanos();
 };
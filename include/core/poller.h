@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Looper线程的等待与唤醒
+// Linux上在epoll_wait中睡眠，用eventfd唤醒，同一次等待里还监听注册的文件描述符；
+// 其它平台退回条件变量，不支持文件描述符
+class Poller {
+public:
+    enum Event : uint32_t {
+        EVENT_INPUT = 1 << 0,
+        EVENT_OUTPUT = 1 << 1,
+        EVENT_ERROR = 1 << 2,
+        EVENT_HANGUP = 1 << 3
+    };
+
+    // 在Looper线程上调用，返回false表示注销该描述符
+    using FdCallback = std::function<bool(int fd, uint32_t events)>;
+
+    // mutex为消息队列的锁，条件变量后端需要用它避免丢失唤醒
+    explicit Poller(std::mutex& mutex);
+    ~Poller();
+    Poller(const Poller&) = delete;
+    Poller& operator=(const Poller&) = delete;
+
+    // 持有lock调用，等待期间释放；deadlineNanos为steady_clock时间，小于0表示一直等待
+    // 有描述符就绪时在锁外执行其回调，返回时重新持有lock
+    void wait(std::unique_lock<std::mutex>& lock, int64_t deadlineNanos);
+
+    // 持有lock调用，不等待，只执行已就绪描述符的回调（在锁外）
+    // 消息持续到来时Looper不会进入wait，用它定期检查描述符；没有注册描述符时不做系统调用
+    void poll(std::unique_lock<std::mutex>& lock);
+
+    // 任意线程调用，使正在或即将进行的wait返回
+    void wake();
+
+    // 任意线程调用，同一描述符重复注册时替换原有的事件和回调
+    bool addFd(int fd, uint32_t events, FdCallback callback);
+    bool removeFd(int fd);
+
+private:
+    std::mutex& queueMutex;
+    std::condition_variable wakeCondition;
+
+#ifdef __linux__
+    int epollFd = -1;
+    int wakeFd = -1;
+
+    std::mutex fdMutex;
+    std::unordered_map<int, std::shared_ptr<FdCallback>> fdCallbacks;
+    std::atomic<size_t> fdCount{0};
+
+    void dispatchEvents(const struct epoll_event* events, int count);
+    void dispatchFd(int fd, uint32_t events);
+#endif
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include "core/inline_callback.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Handler;
+struct HandlerAnchor;
+
+// 工作窃取线程池，用于图片解码、文本整形、分块光栅化等可并行的工作
+// 每个工作线程有自己的任务队列：自己从尾部取（后进先出，缓存友好），空闲时从别人的头部窃取
+// 没有任务时线程睡在条件变量上，不轮询
+class ThreadPool {
+public:
+    using Task = InlineCallback;
+
+    // 全局共享的线程池，线程数等于CPU核数
+    static ThreadPool& getInstance();
+
+    explicit ThreadPool(size_t threadCount);
+    ~ThreadPool();  // 执行完已提交的任务后退出
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 在工作线程上提交时放进本线程的队列，否则轮流分给各工作线程
+    void submit(Task task);
+
+    // 任务完成后把continuation投递到handler所在的Looper线程执行
+    // 只持有handler的锚点，handler先析构时continuation不再执行，随任务一起销毁
+    void submit(Task task, Handler* handler, InlineCallback continuation);
+
+    size_t getThreadCount() const { return workers.size(); }
+
+    // 当前线程是否为本线程池的工作线程
+    bool isWorkerThread() const;
+
+private:
+    friend class TaskGroup;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> queuedTasks{0};
+    std::atomic<size_t> sleepingWorkers{0};
+    std::atomic<size_t> nextWorker{0};
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable workAvailable;
+    // 在TaskGroup::wait中睡眠的线程，有新任务或某个组完成时唤醒，由sleepMutex保护
+    std::atomic<size_t> waitingGroups{0};
+    std::condition_variable groupProgress;
+
+    void workerLoop(size_t index);
+    // 依次尝试自己的队列（index有效时）和其它队列，取到任务返回true
+    bool takeTask(size_t index, Task& task);
+    // 在任意线程上取一个任务执行，等待TaskGroup时帮忙用
+    bool runPendingTask();
+    // 睡到有可以帮忙的任务或pending归零
+    void waitForTasks(const std::atomic<size_t>& pending);
+    // 某个组的任务全部完成后调用
+    void notifyGroupDone();
+};
+
+// 一组任务，wait()等待组内全部完成；等待期间调用线程也执行线程池中的任务
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::getInstance());
+    ~TaskGroup();  // 等待未完成的任务
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(InlineCallback task);
+    void wait();
+
+    // 组内任务全部完成后把continuation投递到handler所在线程，已全部完成时立即投递
+    // handler先析构时continuation不再执行
+    void notify(Handler* handler, InlineCallback continuation);
+
+private:
+    struct State {
+        std::atomic<size_t> pending{0};
+        std::mutex mutex;
+        std::shared_ptr<HandlerAnchor> anchor;
+        InlineCallback continuation;
+    };
+
+    ThreadPool& pool;
+    // 任务持有共享状态，组对象先于任务析构时也安全
+    std::shared_ptr<State> state;
+
+    static void finishTask(State& state, ThreadPool& pool);
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Message;
+
+// 延迟消息用的分层时间轮，精度1毫秒
+// 4层各256槽，第0层每槽1毫秒，往上每层是下一层整圈的跨度，共覆盖约49天；
+// 更远的消息先放在最高层，转到时再按剩余时间重新插入
+// 插入和删除都是O(1)，消息通过Message::wheelPrev/wheelNext挂在槽的双向链表上
+// 不是线程安全的，由MessageQueue在持有mutex时使用
+class TimingWheel {
+public:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 8;
+    static constexpr int kSlots = 1 << kSlotBits;
+
+    TimingWheel() = default;
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // 毫秒刻度，向上取整，保证消息不会早于msg->when执行
+    static int64_t tickFor(int64_t whenNanos) {
+        return (whenNanos + 999999) / 1000000;
+    }
+
+    // 第一次使用前设置起始刻度
+    void reset(int64_t tick);
+    int64_t getCurrentTick() const { return currentTick; }
+
+    // 到期刻度必须晚于当前刻度
+    void insert(Message* msg);
+    void remove(Message* msg);
+    bool contains(const Message* msg) const;
+
+    // 推进到tick，到期的消息追加到expired
+    void advance(int64_t tick, std::vector<Message*>& expired);
+
+    // 下一次需要推进的刻度（有消息到期或需要降层），空时返回-1
+    int64_t nextTick() const;
+
+    // 取出全部消息，用于清空队列或按条件删除
+    void takeAll(std::vector<Message*>& out);
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    Message* slots[kLevels][kSlots] = {};
+    uint64_t occupied[kLevels][kSlots / 64] = {};
+    int64_t currentTick = 0;
+    size_t count = 0;
+
+    void place(Message* msg, int64_t minDelta);
+    void link(Message* msg, int level, int slot);
+    void cascade(int level, int slot);
+};
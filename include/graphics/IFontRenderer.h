@@ -1,8 +1,11 @@
 #pragma once
 #include "core/types.h"
 #include "graphics/bitmap.h"
+#include "graphics/matrix.h"
+#include "graphics/text_blob.h"
 #include <string>
 #include <memory>
+#include <vector>
 
 // 基础文本样式
 struct TextStyle {
@@ -17,6 +20,13 @@ struct TextStyle {
     std::string script = "Latn";
 };
 
+// 屏幕子像素排列，None表示使用灰度抗锯齿
+enum class SubpixelOrder {
+    None,
+    RGB,
+    BGR
+};
+
 // 字体渲染器接口
 class IFontRenderer {
 public:
@@ -32,12 +42,31 @@ public:
         int vertAdvance;    // 垂直方向的前进值
     };
 
+    // 字体级度量，单位为像素，上升和下降均为正值
+    struct FontMetrics {
+        float ascent = 0;       // 基线到字体顶部
+        float descent = 0;      // 基线到字体底部
+        float lineGap = 0;      // 行间额外间距
+        float xHeight = 0;
+        float capHeight = 0;
+
+        float getLineHeight() const { return ascent + descent + lineGap; }
+        // 行框顶部到基线的距离，行间距平分到上下两侧
+        float getBaselineOffset() const { return lineGap / 2.0f + ascent; }
+
+        // 没有可用字体时按字号估算
+        static FontMetrics estimate(float size) {
+            return {size * 0.8f, size * 0.2f, size * 0.2f, size * 0.5f, size * 0.7f};
+        }
+    };
+
     struct ShapedGlyph {
         uint32_t glyphId;
         float x_advance;
         float y_advance;
         float x_offset;
         float y_offset;
+        uint32_t cluster;   // 字形对应的UTF-8字节偏移
     };
 
     virtual ~IFontRenderer() = default;
@@ -50,8 +79,45 @@ public:
                           const TextStyle& style,
                           int x, int y) = 0;
                           
+    // 用距离场字形绘制经过matrix变换的文本，(x, y)为变换前的基线起点
+    virtual void renderTextTransformed(Bitmap* bitmap,
+                                       const std::string& text,
+                                       const TextStyle& style,
+                                       const Matrix& matrix,
+                                       float x, float y) = 0;
+                          
+    // 整形并定位文本，结果可以缓存后反复绘制
+    virtual std::shared_ptr<const TextBlob> makeTextBlob(const std::string& text,
+                                                         const TextStyle& style) = 0;
+    
+    // 绘制TextBlob，(x, y)为基线起点
+    virtual void renderTextBlob(Bitmap* bitmap,
+                                const TextBlob& blob,
+                                Color color,
+                                int x, int y) = 0;
+    
+    virtual void renderTextBlobTransformed(Bitmap* bitmap,
+                                           const TextBlob& blob,
+                                           Color color,
+                                           const Matrix& matrix,
+                                           float x, float y) = 0;
+                          
     virtual Size getTextSize(const std::string& text,
                            const TextStyle& style) = 0;
+    
+    // 主字体在style.size下的度量，按(字体, 字号)缓存
+    virtual FontMetrics getFontMetrics(const TextStyle& style) = 0;
+    
+    // 按字节返回前进宽度：簇的宽度记在簇首字节上，其余字节为0
+    virtual std::vector<float> getTextAdvances(const std::string& text,
+                                               const TextStyle& style) = 0;
+    
+    // 设置LCD子像素抗锯齿，只对BGRA8888目标生效，其它格式仍使用灰度遮罩
+    virtual void setSubpixelOrder(SubpixelOrder order) = 0;
+    
+    // 设置字体的后备链，主字体缺字时按顺序查找
+    virtual void setFallbackFonts(const std::string& name,
+                                  const std::vector<std::string>& fallbacks) = 0;
 };
 
 std::unique_ptr<IFontRenderer> createDefaultFontRenderer(); 
\ No newline at end of file
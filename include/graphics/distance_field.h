@@ -0,0 +1,13 @@
+#pragma once
+#include "graphics/bitmap.h"
+#include "graphics/glyph_cache.h"
+#include "graphics/matrix.h"
+
+// 距离场字形以固定参考字号生成一次，之后在任意仿射变换下采样
+constexpr int kDistanceFieldSize = 48;    // 参考字号（像素）
+constexpr int kDistanceFieldSpread = 8;   // 距离场覆盖的范围，FreeType默认值
+
+// 把距离场字形按fieldToDevice（距离场像素坐标 -> 设备坐标）绘制到位图上
+// 每个设备像素经逆变换回到距离场中双线性采样，抗锯齿宽度随缩放自适应
+void drawDistanceField(Bitmap* target, const CachedGlyph& field,
+                       const Matrix& fieldToDevice, Color color);
@@ -0,0 +1,87 @@
+#pragma once
+#include "graphics/IFontRenderer.h"
+#include "graphics/gap_buffer.h"
+#include <string>
+#include <vector>
+
+// 可编辑文本的增量排版
+// 文本按换行符分成段落，段落再按换行机会切成长度有限的整形片段（run）
+// 编辑时只重新整形编辑位置附近的片段，并从编辑所在行开始重新折行，
+// 新的行首与旧的行首重合后直接复用后面的行
+class EditableLayout {
+public:
+    struct Run {
+        size_t start = 0;   // 段内字节偏移
+        size_t length = 0;
+    };
+
+    struct Line {
+        size_t start = 0;   // 段内字节偏移
+        size_t end = 0;     // 下一行的起点，包含行尾空白
+        float width = 0;    // 不含行尾空白的宽度
+    };
+
+    struct Paragraph {
+        size_t start = 0;       // 在全文中的字节偏移
+        size_t length = 0;      // 不含换行符
+        size_t firstLine = 0;   // 第一行在全文中的行号
+        std::vector<Run> runs;
+        std::vector<float> advances;    // 每字节宽度，簇宽度记在首字节上
+        std::vector<uint8_t> breaks;    // 每字节前的换行机会，见LineBreaker
+        std::vector<Line> lines;
+    };
+
+    EditableLayout(IFontRenderer& renderer, const TextStyle& style, int maxWidth);
+
+    // 全量排版
+    void reset(const GapBuffer& text);
+    // 宽度变化只重新折行，不重新整形
+    void setMaxWidth(const GapBuffer& text, int maxWidth);
+    int getMaxWidth() const { return maxWidth; }
+
+    // 文本修改后调用，text为修改后的内容
+    void onInsert(const GapBuffer& text, size_t pos, size_t length);
+    void onErase(const GapBuffer& text, size_t pos, size_t length);
+
+    size_t getParagraphCount() const { return paragraphs.size(); }
+    const Paragraph& getParagraph(size_t index) const { return paragraphs[index]; }
+    // 返回包含pos的段落，pos为换行符时属于前一段
+    size_t findParagraph(size_t pos) const;
+    // 返回包含全局行号line的段落
+    size_t findParagraphForLine(size_t line) const;
+
+    size_t getLineCount() const { return lineCount; }
+    float getLineHeight() const { return lineHeight; }
+    // 行框顶部到基线的距离
+    float getBaselineOffset() const { return baselineOffset; }
+    float getHeight() const { return lineHeight * lineCount; }
+
+    // 光标所在的全局行号和行内x坐标
+    void getCaretPosition(size_t pos, size_t& line, float& x) const;
+
+private:
+    static constexpr size_t kMinRunBytes = 64;     // 片段在此长度后的第一个换行机会处结束
+    static constexpr size_t kMaxRunBytes = 1024;   // 没有换行机会时强制切分
+
+    IFontRenderer& renderer;
+    TextStyle style;
+    int maxWidth;
+    float lineHeight;
+    float baselineOffset;
+    std::vector<Paragraph> paragraphs;
+    size_t lineCount = 0;
+
+    // 替换[pos, pos + oldLength)为新文本中的[pos, pos + newLength)
+    void replace(const GapBuffer& text, size_t pos, size_t oldLength, size_t newLength);
+    Paragraph buildParagraph(const GapBuffer& text, size_t start, size_t length);
+    // 把段内[from, to)切分成片段并整形，新片段插入到runs[runIndex]处
+    void reshape(const GapBuffer& text, Paragraph& paragraph, size_t runIndex,
+                 size_t from, size_t to);
+    // 从包含from的前一行开始重新折行，越过stableFrom后与旧行首重合即停止
+    void rebreak(const GapBuffer& text, Paragraph& paragraph, size_t from,
+                 size_t stableFrom, ptrdiff_t delta);
+    size_t breakLine(const GapBuffer& text, const Paragraph& paragraph,
+                     size_t start, float& width) const;
+    // 平移last之后段落的起点，并从first开始重新计算各段的首行行号
+    void updateFollowing(size_t first, size_t last, ptrdiff_t delta);
+};
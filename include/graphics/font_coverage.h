@@ -0,0 +1,37 @@
+#pragma once
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// 字体码点覆盖表
+// 两级位图：每页256个码点，空页和满页共享同一份数据
+class FontCoverage {
+public:
+    FontCoverage();
+
+    // 从字体的Unicode cmap构建，只需在加载时执行一次
+    void build(FT_Face face);
+
+    bool covers(uint32_t codepoint) const {
+        if (codepoint >= kMaxCodepoint) {
+            return false;
+        }
+        const auto& page = pages[pageIndex[codepoint >> kPageShift]];
+        uint32_t bit = codepoint & (kPageSize - 1);
+        return (page[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+private:
+    static constexpr uint32_t kMaxCodepoint = 0x110000;
+    static constexpr int kPageShift = 8;
+    static constexpr uint32_t kPageSize = 1u << kPageShift;
+    static constexpr uint16_t kEmptyPage = 0;
+    static constexpr uint16_t kFullPage = 1;
+
+    using Page = std::array<uint64_t, kPageSize / 64>;
+
+    std::vector<uint16_t> pageIndex;  // 每页在pages中的下标
+    std::vector<Page> pages;
+};
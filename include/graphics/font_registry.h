@@ -0,0 +1,126 @@
+#pragma once
+#include "core/mapped_file.h"
+#include "graphics/freetype_wrapper.h"
+#include "graphics/harfbuzz_wrapper.h"
+#include "graphics/font_coverage.h"
+#include "graphics/glyph_cache.h"
+#include "graphics/shape_cache.h"
+#include "graphics/simple_shaper.h"
+#include "graphics/text_disk_cache.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class FontRegistry;
+class MessageQueue;
+
+// 已打开的字体，由所有渲染器共享
+struct FontFace {
+    FT_Face ftFace = nullptr;
+    hb_font_t* hbFont = nullptr;
+    FontCoverage coverage;
+    uint64_t fileHash = 0;  // 持久化缓存中标识字体
+    bool simpleShaping = false;  // 可对简单文本使用SimpleShaper
+    const uint8_t* fileData = nullptr;  // 映射的字体文件，创建副本时使用
+    size_t fileSize = 0;
+
+    // FT_Face不是线程安全的，设置字号、整形和光栅化时需持有此锁
+    std::mutex mutex;
+
+    // 切换像素字号并同步HarfBuzz的缩放，调用前需持有mutex
+    void setPixelSize(int size);
+
+    // 按字号缓存的字体度量，调用前需持有mutex
+    std::unordered_map<int, IFontRenderer::FontMetrics> metricsBySize;
+    // 按字号缓存的Latin-1字形表，调用前需持有mutex
+    std::unordered_map<int, std::unique_ptr<Latin1Table>> latin1Tables;
+
+private:
+    int currentSize = 0;
+};
+
+// 注册表中的一个字体文件，首次使用时才映射并创建字体
+class FontEntry {
+public:
+    const std::string& getPath() const { return path; }
+
+    // 返回共享字体，打开失败时返回nullptr
+    FontFace* getFace();
+
+private:
+    friend class FontRegistry;
+    FontEntry(FontRegistry* owner, std::string path)
+        : owner(owner), path(std::move(path)) {}
+
+    FontRegistry* owner;
+    std::string path;
+    std::once_flag openFlag;
+    MappedFile file;
+    std::unique_ptr<FontFace> face;
+};
+
+// 进程级字体注册表
+// 字体文件通过内存映射共享，所有RenderContext使用同一份字体和字形缓存
+class FontRegistry {
+public:
+    static FontRegistry& getInstance();
+
+    // 只记录名称到路径的映射，不读取文件
+    bool registerFont(const std::string& name, const std::string& path);
+    void setFallbackFonts(const std::string& name,
+                          const std::vector<std::string>& fallbacks);
+
+    // 主字体在前，后备字体按设置顺序排列
+    std::vector<FontEntry*> getFontChain(const std::string& name);
+
+    // 注册或后备链变化时递增，用于让渲染器的链缓存失效
+    uint64_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+
+    GlyphCache& getGlyphCache() { return glyphCache; }
+    ShapeCache& getShapeCache() { return shapeCache; }
+
+    // 启用持久化的字形和整形缓存，需在开始绘制之前调用
+    void enablePersistentCache(const std::string& path);
+    const TextDiskCache& getDiskCache() const { return diskCache; }
+    // 新生成了字形或整形结果，间隔kWriteBackInterval后在当前线程空闲时写回缓存文件
+    void notifyCacheMiss();
+    // 上一次写回仍在进行时跳过并返回false
+    bool writeBackPersistentCache();
+
+    // 创建与共享字体使用同一份映射数据的独立FT_Face，供并行光栅化时各线程私有，失败时返回nullptr
+    FT_Face createFaceClone(const FontFace& font);
+    void destroyFaceClone(FT_Face face);
+
+private:
+    friend class FontEntry;
+    FontRegistry();
+    ~FontRegistry();
+
+    void openFace(FontEntry& entry);
+    void scheduleWriteBack(MessageQueue* queue);
+
+    std::mutex mutex;
+    std::mutex libraryMutex;  // 创建字体需要串行访问FT_Library
+    FreeTypeWrapper ftWrapper;
+    HarfBuzzWrapper hbWrapper;
+
+    std::unordered_map<std::string, std::unique_ptr<FontEntry>> entries;  // 按路径
+    std::unordered_map<std::string, FontEntry*> names;
+    std::unordered_map<std::string, std::vector<std::string>> fallbackNames;
+    std::atomic<uint64_t> generation{0};
+    GlyphCache glyphCache;
+    ShapeCache shapeCache;
+
+    TextDiskCache diskCache;
+    std::string diskCachePath;
+    static constexpr std::chrono::seconds kWriteBackInterval{10};
+    std::atomic<bool> writeBackScheduled{false};
+    std::atomic<bool> writeBackRunning{false};
+    std::chrono::steady_clock::time_point lastWriteBack;
+    std::thread writeBackThread;
+};
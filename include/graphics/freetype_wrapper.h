@@ -2,6 +2,7 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include "graphics/bitmap.h"
+#include "graphics/glyph_cache.h"
 #include "graphics/IFontRenderer.h"
 
 class FreeTypeWrapper {
@@ -13,14 +14,29 @@ public:
     void cleanup();
     
     FT_Error loadFace(const std::string& fontPath, FT_Face* face);
+    // 从内存（通常是映射的字体文件）创建字体，数据需在字体销毁前保持有效
+    FT_Error loadMemoryFace(const uint8_t* data, size_t size, FT_Face* face);
     void destroyFace(FT_Face face);
     
-    bool renderGlyph(FT_Face face, uint32_t glyphIndex, int size);
+    // 以当前字号渲染，字号由调用方通过FontFace::setPixelSize设置
+    // xShift为26.6格式的水平子像素偏移
+    bool renderGlyph(FT_Face face, uint32_t glyphIndex, FT_Pos xShift = 0);
+    // 生成LCD子像素遮罩，位图宽度为像素宽度的3倍
+    bool renderGlyphLcd(FT_Face face, uint32_t glyphIndex, FT_Pos xShift = 0);
+    // 以当前字号生成距离场字形，FreeType低于2.11时不支持并返回false
+    bool renderGlyphDistanceField(FT_Face face, uint32_t glyphIndex);
     void drawGlyphBitmap(Bitmap* target, const FT_Bitmap& bitmap,
                         int x, int y, Color color);
-    IFontRenderer::GlyphMetrics getGlyphMetrics(FT_Face face, 
-                                               uint32_t glyphIndex,
-                                               int size);
+    void drawGlyphMask(Bitmap* target, const CachedGlyph& glyph,
+                       int x, int y, Color color);
+    // 按子像素分别混合LCD遮罩，目标需为BGRA8888
+    void drawGlyphLcdMask(Bitmap* target, const CachedGlyph& glyph,
+                          int x, int y, Color color, SubpixelOrder order);
+    // 读取已设置字号的字体的度量，OS/2表缺少x高度和大写字母高度时量取'x'和'H'
+    IFontRenderer::FontMetrics getFontMetrics(FT_Face face);
+    // 读取当前字号下的字形度量
+    IFontRenderer::GlyphMetrics getGlyphMetrics(FT_Face face,
+                                               uint32_t glyphIndex);
 private:
     FT_Library library = nullptr;
 }; 
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// 间隙缓冲区，连续位置上的插入和删除为均摊O(1)
+class GapBuffer {
+public:
+    GapBuffer() = default;
+    explicit GapBuffer(const std::string& text);
+
+    void insert(size_t pos, const char* data, size_t length);
+    void insert(size_t pos, const std::string& text) { insert(pos, text.data(), text.size()); }
+    void erase(size_t pos, size_t length);
+    void clear();
+
+    size_t size() const { return buffer.size() - gapLength(); }
+    bool empty() const { return size() == 0; }
+    char at(size_t pos) const {
+        return pos < gapStart ? buffer[pos] : buffer[pos + gapLength()];
+    }
+
+    std::string substr(size_t pos, size_t length) const;
+    std::string toString() const { return substr(0, size()); }
+
+    // 在[from, size)中查找字符，未找到返回size()
+    size_t find(char c, size_t from) const;
+    // 在[0, before)中反向查找字符，未找到返回npos
+    size_t rfind(char c, size_t before) const;
+
+private:
+    static constexpr size_t kMinGap = 64;
+
+    std::vector<char> buffer;
+    size_t gapStart = 0;
+    size_t gapEnd = 0;
+
+    size_t gapLength() const { return gapEnd - gapStart; }
+    void moveGap(size_t pos);
+    void reserveGap(size_t length);
+};
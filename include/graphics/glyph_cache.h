@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 缓存中字形数据的格式
+enum class GlyphFormat : uint8_t {
+    Coverage,       // 8位覆盖率遮罩
+    DistanceField,  // 8位有符号距离场，128为轮廓
+    Lcd             // 每像素3个子像素覆盖率，按FreeType输出的从左到右顺序排列
+};
+
+// 字形缓存键
+struct GlyphKey {
+    const void* face = nullptr;  // 字体句柄
+    uint32_t glyphId = 0;
+    uint16_t size = 0;
+    uint8_t subpixel = 0;        // 水平子像素相位
+    GlyphFormat format = GlyphFormat::Coverage;
+
+    bool operator==(const GlyphKey& other) const = default;
+};
+
+struct GlyphKeyHash {
+    size_t operator()(const GlyphKey& key) const;
+};
+
+// 光栅化后的字形覆盖率遮罩
+struct CachedGlyph {
+    int width = 0;               // 遮罩宽度（像素）
+    int rows = 0;                // 遮罩高度（像素）
+    int left = 0;                // 相对笔位置的水平偏移
+    int top = 0;                 // 相对基线的垂直偏移（向上为正）
+    std::vector<uint8_t> coverage; // 紧凑排列，行跨度等于width（LCD格式为width * 3）；距离场格式时为距离值
+};
+
+// 字形缓存，按字节预算做LRU淘汰，可被多个渲染器共享
+class GlyphCache {
+public:
+    // 水平子像素相位数，每个相位对应1/4像素的偏移
+    static constexpr int kSubpixelPhases = 4;
+
+    explicit GlyphCache(size_t maxBytes = 4 * 1024 * 1024);
+
+    std::shared_ptr<const CachedGlyph> find(const GlyphKey& key);
+    std::shared_ptr<const CachedGlyph> insert(const GlyphKey& key, CachedGlyph glyph);
+    void clear();
+
+    // 按最近使用顺序复制当前内容，只复制共享指针
+    std::vector<std::pair<GlyphKey, std::shared_ptr<const CachedGlyph>>> snapshot() const;
+
+    size_t getByteSize() const;
+    size_t getMaxBytes() const { return maxBytes; }
+
+private:
+    using Entry = std::pair<GlyphKey, std::shared_ptr<const CachedGlyph>>;
+
+    mutable std::mutex mutex;
+    std::list<Entry> lru;  // 头部为最近使用
+    std::unordered_map<GlyphKey, std::list<Entry>::iterator, GlyphKeyHash> index;
+    size_t maxBytes;
+    size_t byteSize = 0;
+
+    static size_t entryBytes(const CachedGlyph& glyph);
+    void evict(size_t incoming);
+};
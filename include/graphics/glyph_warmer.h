@@ -0,0 +1,21 @@
+#pragma once
+#include "graphics/IFontRenderer.h"
+#include <future>
+#include <string>
+#include <vector>
+
+// 字形缓存预热：在共享线程池上整形并光栅化一批文本，结果写入FontRegistry的共享缓存
+// 首次绘制时直接命中缓存，不必在绘制过程中串行光栅化
+class GlyphWarmer {
+public:
+    struct Item {
+        std::string text;
+        TextStyle style;
+    };
+
+    // 阻塞直到全部完成，调用线程也参与处理；threadCount为并行任务数，为0时等于线程池大小
+    static void warm(const std::vector<Item>& items, unsigned threadCount = 0);
+
+    // 在后台执行warm，返回的future可用于等待完成
+    static std::future<void> warmAsync(std::vector<Item> items, unsigned threadCount = 0);
+};
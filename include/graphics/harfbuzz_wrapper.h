@@ -15,4 +15,22 @@ public:
         hb_font_t* font,
         const std::string& text,
         const TextStyle& style);
+    
+    // 只整形[start, start + length)范围，其余文本作为上下文
+    std::vector<IFontRenderer::ShapedGlyph> shapeText(
+        hb_font_t* font,
+        const std::string& text,
+        size_t start,
+        size_t length,
+        const TextStyle& style);
+
+    // 以显式的方向和书写系统整形，用于分项后的片段
+    std::vector<IFontRenderer::ShapedGlyph> shapeText(
+        hb_font_t* font,
+        const std::string& text,
+        size_t start,
+        size_t length,
+        hb_direction_t direction,
+        hb_script_t script,
+        const std::string& language);
 };
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 只追加的大文本文档
+// 文本按固定容量分块存储，追加只拷贝新字节；行首索引由后台线程增量建立
+class LargeTextDocument {
+public:
+    LargeTextDocument();
+    ~LargeTextDocument();
+
+    LargeTextDocument(const LargeTextDocument&) = delete;
+    LargeTextDocument& operator=(const LargeTextDocument&) = delete;
+
+    // 追加文本，耗时只与追加的字节数有关
+    void append(const char* data, size_t size);
+    void append(const std::string& text) { append(text.data(), text.size()); }
+    void clear();
+
+    size_t getSize() const;
+    // 已建立索引的行数，最后一行可能仍在增长
+    size_t getLineCount() const;
+    bool isIndexing() const;
+
+    // 取出第index行（不含换行符），最多maxBytes字节，截断在码点边界上
+    std::string getLine(size_t index, size_t maxBytes = std::string::npos) const;
+
+    // 索引有进展时在后台线程回调，回调中不要访问UI
+    void setIndexListener(std::function<void()> listener);
+
+private:
+    static constexpr size_t kChunkSize = 1 << 20;      // 每块1MB
+    static constexpr size_t kIndexStep = 256 * 1024;   // 后台每次扫描的字节数
+
+    struct Chunk {
+        std::unique_ptr<char[]> data{new char[kChunkSize]};
+        size_t size = 0;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable indexCondition;
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    std::vector<size_t> lineStarts;   // 每行首字节的偏移，lineStarts[0]恒为0
+    size_t totalSize = 0;
+    size_t indexedSize = 0;           // 已扫描过换行符的字节数
+    uint64_t generation = 0;          // clear()后递增，丢弃过期的扫描结果
+    bool quitting = false;
+    std::function<void()> indexListener;
+    std::thread indexThread;
+
+    void indexLoop();
+    void copyRange(size_t start, size_t end, std::string& out) const;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// UAX #14 换行机会分析
+// 实现了界面文本常用的规则子集：强制换行、空格、标点、括号、数字、表意文字等
+class LineBreaker {
+public:
+    enum Break : uint8_t {
+        None = 0,       // 不可换行
+        Allowed = 1,    // 可在此字节前换行
+        Mandatory = 2   // 必须在此字节前换行
+    };
+
+    // 返回与text等长的数组，breaks[i]表示在字节i之前的换行类型
+    // breaks[0]恒为None，换行位置总在码点边界上
+    static std::vector<uint8_t> analyze(const std::string& text);
+
+    // UAX #14 行断类别（子集）
+    enum class LineBreakClass : uint8_t {
+        BK, CR, LF, CM, ZW, ZWJ, WJ, GL, SP,
+        OP, CL, CP, QU, EX, IS, SY, NS, HY, BA, BB,
+        NU, AL, ID
+    };
+
+    static LineBreakClass classify(uint32_t codepoint);
+};
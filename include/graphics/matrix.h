@@ -21,6 +21,9 @@ public:
     Point mapPoint(const Point& point) const;
     Rect mapRect(const Rect& rect) const;
     
+    // 求仿射变换的逆矩阵，不可逆时返回false
+    bool invert(Matrix& inverse) const;
+    
 private:
     static constexpr float kPI = 3.14159265358979323846f;
 }; 
\ No newline at end of file
@@ -18,12 +18,15 @@ public:
     void setStrokeWidth(float width) { strokeWidth = width; }
     void setTextSize(float size) { textSize = size; }
     void setAlpha(uint8_t alpha) { this->alpha = alpha; }
+    // 使用距离场字形绘制文本，适合缩放、旋转和动画中的文本
+    void setDistanceFieldText(bool enabled) { distanceFieldText = enabled; }
     
     Color getColor() const { return color; }
     Style getStyle() const { return style; }
     float getStrokeWidth() const { return strokeWidth; }
     float getTextSize() const { return textSize; }
     uint8_t getAlpha() const { return alpha; }
+    bool isDistanceFieldText() const { return distanceFieldText; }
     
     float measureText(const std::string& text) const;
     float getTextHeight() const;
@@ -34,4 +37,5 @@ private:
     float strokeWidth = 1.0f;
     float textSize = 12.0f;
     uint8_t alpha = 255;
+    bool distanceFieldText = false;
 }; 
\ No newline at end of file
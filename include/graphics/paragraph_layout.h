@@ -0,0 +1,115 @@
+#pragma once
+#include "graphics/IFontRenderer.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 段落排版结果：按UAX #14换行机会把文本折成多行
+// 对象创建后不可变，可在measure、draw以及多帧之间共享
+class ParagraphLayout {
+public:
+    enum class BreakStrategy {
+        Greedy,     // 每行尽量填满
+        Balanced    // 行数最少的前提下让各行宽度尽量均匀
+    };
+
+    struct Options {
+        BreakStrategy breakStrategy = BreakStrategy::Greedy;
+        int maxLines = 0;        // 0表示不限制行数
+        bool ellipsize = false;  // 超出maxLines时在末行结尾显示省略号
+
+        bool operator==(const Options& other) const = default;
+    };
+
+    struct Line {
+        size_t start = 0;        // 行首字节偏移
+        size_t end = 0;          // 行尾字节偏移，不含行尾空白和换行符
+        float width = 0;         // 行宽，包含省略号
+        bool ellipsized = false;
+    };
+
+    // maxWidth <= 0 时只在强制换行处折行
+    ParagraphLayout(IFontRenderer& renderer,
+                    const std::string& text,
+                    const TextStyle& style,
+                    int maxWidth,
+                    const Options& options);
+
+    const std::string& getText() const { return text; }
+    const std::vector<Line>& getLines() const { return lines; }
+    size_t getLineCount() const { return lines.size(); }
+    std::string getLineText(size_t index) const;
+
+    float getWidth() const { return width; }  // 最宽行的宽度
+    float getLineHeight() const { return lineHeight; }
+    // 行框顶部到基线的距离
+    float getBaselineOffset() const { return baselineOffset; }
+    float getHeight() const { return lineHeight * lines.size(); }
+    int getMaxWidth() const { return maxWidth; }
+
+    // 在给定宽度下重新排版是否会得到相同结果
+    bool isValidForWidth(int availableWidth) const;
+
+private:
+    std::string text;
+    std::vector<Line> lines;
+    int maxWidth;
+    float width = 0;
+    float lineHeight = 0;
+    float baselineOffset = 0;
+    bool softWrapped = false;  // 是否发生过非强制换行
+
+    // 前缀宽度，prefix[i]为text[0, i)的宽度
+    std::vector<float> prefix;
+
+    float measure(size_t start, size_t end) const { return prefix[end] - prefix[start]; }
+    size_t trimEnd(size_t start, size_t end) const;
+    size_t fitCodepoints(size_t start, size_t end, float available) const;
+    void breakGreedy(size_t start, size_t end, const std::vector<size_t>& candidates);
+    bool breakBalanced(size_t start, size_t end, const std::vector<size_t>& candidates);
+    void addLine(size_t start, size_t end);
+};
+
+// 段落排版缓存，键为(文本, 样式, 宽度, 选项)
+class ParagraphLayoutCache {
+public:
+    static ParagraphLayoutCache& getInstance();
+
+    std::shared_ptr<const ParagraphLayout> get(IFontRenderer& renderer,
+                                               const std::string& text,
+                                               const TextStyle& style,
+                                               int maxWidth,
+                                               const ParagraphLayout::Options& options);
+    void clear();
+
+private:
+    ParagraphLayoutCache() = default;
+
+    struct Key {
+        std::string text;
+        std::string fontName;
+        int size;
+        TextStyle::TextDirection direction;
+        std::string language;
+        std::string script;
+        int maxWidth;
+        ParagraphLayout::Options options;
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    using Entry = std::pair<Key, std::shared_ptr<const ParagraphLayout>>;
+
+    static constexpr size_t kMaxEntries = 256;
+
+    std::mutex mutex;
+    std::list<Entry> lru;  // 头部为最近使用
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+};
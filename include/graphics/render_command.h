@@ -30,7 +30,7 @@ private:
     Paint paint;
 };
 
-// 绘制文本命令
+// 绘制文本命令，首次执行时整形并保存结果，之后重放直接绘制字形
 class DrawTextCommand : public RenderCommand {
 public:
     DrawTextCommand(const std::string& text, float x, float y, const Paint& paint)
@@ -41,4 +41,19 @@ private:
     std::string text;
     float x, y;
     Paint paint;
-}; 
\ No newline at end of file
+    std::shared_ptr<const TextBlob> blob;
+};
+
+// 绘制已整形文本命令
+class DrawTextBlobCommand : public RenderCommand {
+public:
+    DrawTextBlobCommand(std::shared_ptr<const TextBlob> blob, float x, float y,
+                        const Paint& paint)
+        : blob(std::move(blob)), x(x), y(y), paint(paint) {}
+    void execute(RenderContext& context) override;
+    
+private:
+    std::shared_ptr<const TextBlob> blob;
+    float x, y;
+    Paint paint;
+};
@@ -32,6 +32,8 @@ public:
     
     // 文本和图像
     void drawText(const std::string& text, float x, float y, const Paint& paint);
+    // 绘制预先整形的文本，只使用paint的颜色和距离场设置，字号取自blob
+    void drawTextBlob(const TextBlob& blob, float x, float y, const Paint& paint);
     void drawBitmap(const Bitmap& bitmap, float x, float y, const Paint& paint);
     
     // 状态管理
@@ -53,6 +55,9 @@ public:
     // 批量像素操作
     void fillRect(const Rect& rect, const Color& color);
     
+    // 文本测量和排版使用的字体渲染器
+    IFontRenderer* getFontRenderer() const { return fontRenderer.get(); }
+    
 private:
     // 当前绘制状态
     struct State {
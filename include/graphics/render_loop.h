@@ -2,6 +2,8 @@
 #include <thread>
 #include <memory>
 #include <functional>
+#include <future>
+#include <mutex>
 #include "core/handler.h"
 
 /**
@@ -19,9 +21,11 @@ public:
     void stop();
     
     // 在渲染线程上提交任务
-    void post(std::function<void()> task);
+    void post(InlineCallback task);
+    // 按指定优先级在渲染线程上提交，输入和帧作为异步消息不受同步屏障阻挡；未运行时返回false
+    bool post(InlineCallback task, MessagePriority priority);
     // 在渲染线程上延迟提交任务
-    void postDelayed(std::function<void()> task, int64_t delayMillis);
+    void postDelayed(InlineCallback task, int64_t delayMillis);
     
     // 检查当前是否在渲染线程上
     bool isOnRenderThread() const;
@@ -38,12 +42,14 @@ private:
     RenderLoop();
     ~RenderLoop();
     
-    void run();
+    void run(std::promise<void> ready);
     
     std::atomic<bool> isRunning{false};
     std::thread::id renderThreadId;
     std::thread renderThread;
     std::unique_ptr<Looper> looper;
+    // vsync线程和窗口线程也会投递，taskHandler的创建和销毁与投递由handlerMutex互斥
+    std::mutex handlerMutex;
     std::unique_ptr<Handler> taskHandler;
     std::atomic<bool> isPausedFlag{false};  // 跟踪渲染暂停状态
 }; 
\ No newline at end of file
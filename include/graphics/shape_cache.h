@@ -0,0 +1,52 @@
+#pragma once
+#include "graphics/IFontRenderer.h"
+#include <hb.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 整形缓存键，文本为单个片段的内容，不含上下文
+struct ShapeKey {
+    std::string text;
+    const void* face = nullptr;  // 字体句柄
+    uint16_t size = 0;
+    bool rtl = false;
+    hb_script_t script = 0;
+    std::string language;
+
+    bool operator==(const ShapeKey& other) const = default;
+};
+
+struct ShapeKeyHash {
+    size_t operator()(const ShapeKey& key) const;
+};
+
+using ShapedGlyphs = std::vector<IFontRenderer::ShapedGlyph>;
+
+// 片段整形结果的LRU缓存，可被多个渲染器共享
+// 字形的cluster相对片段起点，不同字符串中的相同片段共用一份结果
+class ShapeCache {
+public:
+    explicit ShapeCache(size_t maxEntries = 4096);
+
+    std::shared_ptr<const ShapedGlyphs> find(const ShapeKey& key);
+    std::shared_ptr<const ShapedGlyphs> insert(const ShapeKey& key, ShapedGlyphs glyphs);
+    void clear();
+
+    // 按最近使用顺序复制当前内容，只复制共享指针
+    std::vector<std::pair<ShapeKey, std::shared_ptr<const ShapedGlyphs>>> snapshot() const;
+
+    size_t getSize() const;
+    size_t getMaxEntries() const { return maxEntries; }
+
+private:
+    using Entry = std::pair<ShapeKey, std::shared_ptr<const ShapedGlyphs>>;
+
+    mutable std::mutex mutex;
+    std::list<Entry> lru;  // 头部为最近使用
+    std::unordered_map<ShapeKey, std::list<Entry>::iterator, ShapeKeyHash> index;
+    size_t maxEntries;
+};
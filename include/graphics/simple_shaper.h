@@ -0,0 +1,30 @@
+#pragma once
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include "graphics/shape_cache.h"
+#include <cstdint>
+#include <string>
+
+struct FontFace;
+
+// Latin-1范围内码点到字形和前进宽度的缓存，字形编号与字号无关
+struct Latin1Table {
+    uint32_t glyphs[256] = {};
+    float advances[256] = {};
+};
+
+// 简单文本的整形快速路径，绕过HarfBuzz直接查cmap和hmtx
+// 只在字体没有GSUB、GPOS、kern、morx、kerx表时启用，此时HarfBuzz对Latin-1文本也只做
+// 同样的查表，结果一致；其它情况一律回到HarfBuzz
+class SimpleShaper {
+public:
+    // 只含U+0020-U+007E和U+00A0-U+00FF（不含软连字符U+00AD）的文本
+    static bool isSimpleText(const char* data, size_t length);
+
+    // 字体打开时检查一次
+    static bool supportsFace(FT_Face face);
+
+    // 从左到右整形，遇到字体缺字时返回false，由调用方改用HarfBuzz
+    // 调用前需持有font.mutex并已设置为size字号
+    static bool shape(FontFace& font, int size, const std::string& text, ShapedGlyphs& glyphs);
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct FontFace;
+
+// 已整形、已定位的字形序列，创建后不可修改，可在线程和绘制命令之间共享
+// 重放时直接按字形和位置绘制，不再解码UTF-8、整形或测量
+class TextBlob {
+public:
+    struct Position {
+        float x = 0.0f;  // 相对于绘制原点（基线起点）
+        float y = 0.0f;
+    };
+
+    // 同一字体的一段字形，按视觉顺序排列
+    struct Run {
+        FontFace* font = nullptr;  // 由FontRegistry持有，进程内一直有效
+        std::vector<uint32_t> glyphIds;
+        std::vector<Position> positions;
+    };
+
+    // 以字体上升、下降高度和前进宽度计算的逻辑边界，相对于绘制原点
+    struct Bounds {
+        float left = 0.0f;
+        float top = 0.0f;
+        float right = 0.0f;
+        float bottom = 0.0f;
+
+        float width() const { return right - left; }
+        float height() const { return bottom - top; }
+    };
+
+    TextBlob(int textSize, std::vector<Run> runs, float advance, Bounds bounds)
+        : textSize(textSize), runs(std::move(runs)), advance(advance), bounds(bounds) {}
+
+    int getTextSize() const { return textSize; }
+    const std::vector<Run>& getRuns() const { return runs; }
+    // 整段文本的水平前进宽度
+    float getAdvance() const { return advance; }
+    const Bounds& getBounds() const { return bounds; }
+    bool isEmpty() const { return runs.empty(); }
+
+private:
+    int textSize;
+    std::vector<Run> runs;
+    float advance;
+    Bounds bounds;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "core/mapped_file.h"
+#include "graphics/glyph_cache.h"
+#include "graphics/shape_cache.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 持久化的字形和整形缓存文件，启动时映射，减少冷启动时的光栅化和整形
+// 文件头记录FreeType和HarfBuzz版本，版本不一致时整个文件作废
+// 记录以字体文件哈希代替字体句柄，字体文件变化后旧记录自然不会命中
+// 缓存在path.0和path.1两个文件之间轮流写入，打开代数较新的一个；写回只写没有映射的那个，
+// Windows上已映射的文件不能被替换
+class TextDiskCache {
+public:
+    // 以字体文件哈希标识字体的记录
+    struct GlyphRecord {
+        uint64_t fontHash;
+        GlyphKey key;  // key.face不写入文件
+        std::shared_ptr<const CachedGlyph> glyph;
+    };
+
+    struct ShapeRecord {
+        uint64_t fontHash;
+        ShapeKey key;  // key.face不写入文件
+        std::shared_ptr<const ShapedGlyphs> glyphs;
+    };
+
+    // 映射并校验缓存文件，需在开始绘制之前调用，之后只读
+    bool open(const std::string& path);
+    bool isOpen() const { return file.isOpen(); }
+
+    bool findGlyph(uint64_t fontHash, const GlyphKey& key, CachedGlyph& glyph) const;
+    bool findShape(uint64_t fontHash, const ShapeKey& key, ShapedGlyphs& glyphs) const;
+
+    // 写入没有映射的那个文件（先写临时文件再替换），代数比已映射的新，下次启动时生效
+    // 需在open之后调用，可在任意线程上执行，同一时间只能有一个写入
+    bool write(const std::vector<GlyphRecord>& glyphs,
+               const std::vector<ShapeRecord>& shapes) const;
+
+    // 字体文件的哈希，取文件大小和首尾各64KB，避免打开字体时读完整个文件
+    static uint64_t hashFontFile(const uint8_t* data, size_t size);
+
+private:
+    std::string basePath;
+    MappedFile file;
+    int mappedSlot = -1;          // 已映射的文件序号，没有时为-1
+    uint32_t mappedGeneration = 0;
+    // 记录键的哈希 -> 记录在文件中的偏移，查找时再比较完整的键
+    std::unordered_multimap<uint64_t, size_t> glyphIndex;
+    std::unordered_multimap<uint64_t, size_t> shapeIndex;
+
+    bool buildIndex();
+};
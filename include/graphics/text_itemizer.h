@@ -0,0 +1,35 @@
+#pragma once
+#include <hb.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 文本分项：按双向层级和书写系统把文本切成可以单独整形的片段
+// 双向算法实现了UAX #9中不含显式嵌入、隔离和括号配对的部分（W1-W7、N1-N2、I1-I2、L1-L2）
+class TextItemizer {
+public:
+    struct Item {
+        size_t start = 0;       // 字节偏移
+        size_t length = 0;
+        uint8_t level = 0;      // 双向层级，奇数为从右到左
+        hb_script_t script = HB_SCRIPT_COMMON;
+
+        bool isRtl() const { return (level & 1) != 0; }
+    };
+
+    enum class BidiClass : uint8_t {
+        L, R, AL, EN, ES, ET, AN, CS, NSM, BN, B, S, WS, ON
+    };
+
+    // 返回按逻辑顺序排列的片段，rtl为段落方向
+    static std::vector<Item> itemize(const std::string& text, bool rtl);
+
+    // 按L2规则返回片段的视觉顺序（从左到右的片段下标）
+    static std::vector<size_t> reorder(const std::vector<Item>& items);
+
+    static BidiClass classify(uint32_t codepoint);
+
+    // 为每个码点计算层级
+    static std::vector<uint8_t> resolveLevels(std::vector<BidiClass> classes,
+                                              uint8_t paragraphLevel);
+};
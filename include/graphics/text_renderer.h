@@ -2,43 +2,115 @@
 #include "graphics/IFontRenderer.h"
 #include "graphics/freetype_wrapper.h"
 #include "graphics/harfbuzz_wrapper.h"
+#include "graphics/glyph_cache.h"
+#include "graphics/font_registry.h"
+#include "graphics/text_itemizer.h"
 #include <unordered_map>
 
+// 字体、映射文件和字形缓存都由FontRegistry共享，渲染器本身只保存轻量状态
 class TextRenderer : public IFontRenderer {
 private:
-    FreeTypeWrapper ftWrapper;
+    FreeTypeWrapper ftWrapper;  // 仅用于字形绘制，不持有FT_Library
     HarfBuzzWrapper hbWrapper;
-    
-    struct FontContext {
-        FT_Face ft_face = nullptr;
-        hb_font_t* hb_font = nullptr;
-        std::string path;
+
+    // 使用同一字体、方向和书写系统整形的一段文本，glyphs按视觉顺序排列
+    struct ShapedRun {
+        FontFace* font = nullptr;
+        size_t offset = 0;   // 片段在原文本中的字节偏移，glyph.cluster相对于此
+        std::shared_ptr<const ShapedGlyphs> glyphs;
     };
-    
-    std::unordered_map<std::string, std::unique_ptr<FontContext>> fonts;
+
+    std::unordered_map<std::string, std::vector<FontEntry*>> resolvedChains;
+    uint64_t chainGeneration = 0;
+    SubpixelOrder subpixelOrder = SubpixelOrder::None;
+
+    // 本渲染器私有的字体副本，光栅化时不需要持有共享字体的mutex
+    struct PrivateFace {
+        FT_Face face = nullptr;
+        int size = 0;
+    };
+    bool usePrivateFaces = false;
+    std::unordered_map<FontFace*, PrivateFace> privateFaces;
 
 public:
-    TextRenderer();
+    // privateFaces为true时为每个字体创建私有副本光栅化，多个渲染器可在不同线程上并行预热同一字体
+    explicit TextRenderer(bool privateFaces = false);
     ~TextRenderer();
-    
-    bool loadFont(const std::string& fontPath, 
+
+    bool loadFont(const std::string& fontPath,
                  const std::string& name = "default") override;
-                 
+
     void renderText(Bitmap* bitmap,
                    const std::string& text,
                    const TextStyle& style,
                    int x, int y) override;
-                   
+
+    void renderTextTransformed(Bitmap* bitmap,
+                               const std::string& text,
+                               const TextStyle& style,
+                               const Matrix& matrix,
+                               float x, float y) override;
+
+    std::shared_ptr<const TextBlob> makeTextBlob(const std::string& text,
+                                                 const TextStyle& style) override;
+
+    void renderTextBlob(Bitmap* bitmap,
+                        const TextBlob& blob,
+                        Color color,
+                        int x, int y) override;
+
+    void renderTextBlobTransformed(Bitmap* bitmap,
+                                   const TextBlob& blob,
+                                   Color color,
+                                   const Matrix& matrix,
+                                   float x, float y) override;
+
     Size getTextSize(const std::string& text,
                     const TextStyle& style) override;
 
+    FontMetrics getFontMetrics(const TextStyle& style) override;
+
+    std::vector<float> getTextAdvances(const std::string& text,
+                                       const TextStyle& style) override;
+
+    void setFallbackFonts(const std::string& name,
+                          const std::vector<std::string>& fallbacks) override;
+
+    void setSubpixelOrder(SubpixelOrder order) override { subpixelOrder = order; }
+
+    // 整形并光栅化文本中的所有字形，只写入共享缓存不绘制
+    void prerasterize(const std::string& text, const TextStyle& style);
+
 private:
-    std::vector<ShapedGlyph> shapeText(
+    const std::vector<FontEntry*>& getFontChain(const std::string& name);
+    // 先按双向层级和书写系统分项，再按字体覆盖切分，返回按视觉顺序排列的片段
+    std::vector<ShapedRun> shapeText(
         const std::string& text,
         const TextStyle& style);
-    void renderShapedText(
-        Bitmap* bitmap,
-        const std::vector<ShapedGlyph>& shaped,
+    void shapeItem(
+        const std::string& text,
+        const TextItemizer::Item& item,
+        const std::vector<FontEntry*>& chain,
         const TextStyle& style,
-        int x, int y);
-}; 
\ No newline at end of file
+        std::vector<ShapedRun>& runs);
+    std::shared_ptr<const ShapedGlyphs> shapeRun(
+        FontFace& font,
+        const std::string& text,
+        const TextItemizer::Item& item,
+        const TextStyle& style);
+    std::shared_ptr<const TextBlob> makeTextBlob(
+        const std::vector<ShapedRun>& runs,
+        const TextStyle& style);
+    std::shared_ptr<const CachedGlyph> getGlyph(
+        FontFace& font,
+        uint32_t glyphId,
+        int size,
+        int subpixel,
+        GlyphFormat format = GlyphFormat::Coverage);
+    // 参考字号下的距离场字形，不支持时返回nullptr
+    std::shared_ptr<const CachedGlyph> getDistanceField(
+        FontFace& font,
+        uint32_t glyphId);
+    // 设置好字号的私有副本，未启用或创建失败时返回nullptr
+    FT_Face getPrivateFace(FontFace& font, int size);
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// 替换字符，用于非法序列
+constexpr uint32_t kUtf8ReplacementChar = 0xFFFD;
+
+// 从pos处解码一个码点，并将pos推进到下一个码点
+inline uint32_t decodeUtf8(const char* data, size_t size, size_t& pos) {
+    const auto* s = reinterpret_cast<const uint8_t*>(data);
+    uint8_t lead = s[pos];
+    if (lead < 0x80) {
+        pos++;
+        return lead;
+    }
+
+    int extra;
+    uint32_t cp;
+    if ((lead & 0xE0) == 0xC0) {
+        extra = 1;
+        cp = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        extra = 2;
+        cp = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        extra = 3;
+        cp = lead & 0x07;
+    } else {
+        pos++;
+        return kUtf8ReplacementChar;
+    }
+
+    if (pos + extra >= size) {
+        pos = size;
+        return kUtf8ReplacementChar;
+    }
+    for (int i = 1; i <= extra; i++) {
+        uint8_t c = s[pos + i];
+        if ((c & 0xC0) != 0x80) {
+            pos += i;
+            return kUtf8ReplacementChar;
+        }
+        cp = (cp << 6) | (c & 0x3F);
+    }
+    pos += extra + 1;
+    return cp;
+}
+
+inline uint32_t decodeUtf8(const std::string& text, size_t& pos) {
+    return decodeUtf8(text.data(), text.size(), pos);
+}
+
+// 判断是否为多字节序列的后续字节
+inline bool isUtf8Continuation(char c) {
+    return (static_cast<uint8_t>(c) & 0xC0) == 0x80;
+}
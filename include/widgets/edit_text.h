@@ -0,0 +1,48 @@
+#pragma once
+#include "view/view.h"
+#include "graphics/paint.h"
+#include "graphics/gap_buffer.h"
+#include "graphics/editable_layout.h"
+#include <memory>
+#include <string>
+
+// 可编辑的多行文本控件
+// 文本存放在间隙缓冲区中，每次编辑只增量更新排版
+class EditText : public View {
+public:
+    EditText();
+    explicit EditText(const std::string& text);
+
+    void setText(const std::string& text);
+    std::string getText() const { return buffer.toString(); }
+    size_t getLength() const { return buffer.size(); }
+
+    // 在光标处插入文本，光标移到插入内容之后
+    void insert(const std::string& text);
+    // 删除光标前/后的一个码点
+    void deleteBackward();
+    void deleteForward();
+    // 删除[pos, pos + length)
+    void erase(size_t pos, size_t length);
+
+    void setCursor(size_t pos);
+    size_t getCursor() const { return cursor; }
+
+    void setTextSize(float size);
+    void setTextColor(Color color);
+
+    void onDraw(RenderContext& context) override;
+    void onMeasure(int widthMeasureSpec, int heightMeasureSpec) override;
+
+private:
+    GapBuffer buffer;
+    size_t cursor = 0;
+    Paint textPaint;
+    Paint cursorPaint;
+    std::unique_ptr<EditableLayout> textLayout;
+
+    TextStyle getTextStyle() const;
+    EditableLayout* getLayout(IFontRenderer* renderer, int width);
+    // 编辑后更新排版，行数变化时才需要重新布局
+    void onTextChanged(size_t linesBefore);
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "view/view.h"
+#include "core/handler.h"
+#include "graphics/paint.h"
+#include "graphics/paragraph_layout.h"
+#include "graphics/large_text_document.h"
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// 用于显示超大文本（如日志）的只读视图
+// 每行固定行高、不自动折行，只对可见行及上下少量余量做整形和排版
+class LargeTextView : public View {
+public:
+    LargeTextView();
+    ~LargeTextView() override;
+
+    void setText(const std::string& text);
+    // 追加文本，耗时只与追加的字节数有关
+    void appendText(const std::string& text);
+    void clear();
+
+    void setTextSize(float size);
+    void setTextColor(Color color);
+
+    // 滚动
+    void setScrollY(float y);
+    void scrollBy(float dy);
+    void scrollToLine(size_t line);
+    void scrollToEnd();
+    float getScrollY() const { return scrollY; }
+    float getContentHeight() const;
+    size_t getLineCount() const { return document.getLineCount(); }
+
+    // 滚动到底部时追加的内容自动跟随显示
+    void setFollowTail(bool follow) { followTail = follow; }
+
+    void onDraw(RenderContext& context) override;
+    void onMeasure(int widthMeasureSpec, int heightMeasureSpec) override;
+
+private:
+    static constexpr size_t kVisibleMargin = 8;       // 可见区域上下额外排版的行数
+    static constexpr size_t kMaxCachedLines = 512;    // 行排版缓存上限
+    static constexpr size_t kMaxLineBytes = 4096;     // 单行最多排版的字节数
+
+    using LineEntry = std::pair<size_t, std::shared_ptr<const ParagraphLayout>>;
+
+    // 必须在document之前声明，document的后台线程先于handler退出
+    std::unique_ptr<Handler> uiHandler;
+    std::atomic<bool> indexUpdatePending{false};
+
+    LargeTextDocument document;
+    Paint textPaint;
+    float scrollY = 0;
+    bool followTail = true;
+    bool pinnedToEnd = true;  // 当前是否停在底部
+
+    // 行排版的LRU缓存，头部为最近使用
+    std::list<LineEntry> lineLru;
+    std::unordered_map<size_t, std::list<LineEntry>::iterator> lineIndex;
+    size_t cachedLineCount = 0;
+
+    IFontRenderer::FontMetrics getFontMetrics() const;
+    float getLineHeight() const;
+    float getMaxScrollY() const;
+    TextStyle getTextStyle() const;
+    std::shared_ptr<const ParagraphLayout> getLineLayout(IFontRenderer& renderer, size_t line);
+    void clearLineCache();
+    void onIndexUpdated();
+};
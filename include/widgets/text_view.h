@@ -1,7 +1,10 @@
 #pragma once
 #include "view/view.h"
 #include "graphics/paint.h"
+#include "graphics/paragraph_layout.h"
+#include <memory>
 #include <string>
+#include <vector>
 
 enum class TextAlignment {
     Left,
@@ -23,13 +26,34 @@ public:
     void setTextColor(Color color);
     void setTextAlignment(TextAlignment alignment);
     
+    // 多行排版设置
+    void setMaxLines(int maxLines);
+    void setEllipsize(bool ellipsize);
+    void setBreakStrategy(ParagraphLayout::BreakStrategy strategy);
+    
     // 重写基类方法
     void onDraw(RenderContext& context) override;
     void onMeasure(int widthMeasureSpec, int heightMeasureSpec) override;
     
 protected:
+    TextStyle getTextStyle() const;
+    // 获取指定可用宽度下的排版结果，measure和draw之间复用同一对象
+    std::shared_ptr<const ParagraphLayout> getLayout(IFontRenderer* renderer, int width);
+    void invalidateLayout();
+    // 指定行的TextBlob，排版结果不变时重绘直接复用
+    const TextBlob* getLineBlob(IFontRenderer& renderer,
+                                const std::shared_ptr<const ParagraphLayout>& layout,
+                                size_t line);
+    
     std::string text;
     Paint textPaint;
     TextAlignment textAlignment = TextAlignment::Left;
     float padding = 8.0f;  // 默认内边距
+    
+    ParagraphLayout::Options layoutOptions;
+    std::shared_ptr<const ParagraphLayout> textLayout;
+    
+    // 与blobLayout对应的每行TextBlob，按需创建
+    std::shared_ptr<const ParagraphLayout> blobLayout;
+    std::vector<std::shared_ptr<const TextBlob>> lineBlobs;
 }; 
\ No newline at end of file
@@ -27,6 +27,11 @@ void Activity::finish() {
     }
 }
 
+void Activity::warmGlyphCache(std::vector<GlyphWarmer::Item> items) {
+    // 不等待完成，未预热到的字形在绘制时照常光栅化
+    glyphWarmup = GlyphWarmer::warmAsync(std::move(items));
+}
+
 void Activity::dispatchCreate() {
     state = ActivityState::Created;
     onCreate();
@@ -8,6 +8,7 @@
 #include "view/view_root.h"
 #include "activity/activity.h"
 #include "view/window_manager.h"
+#include "graphics/font_registry.h"
 
 LOG_TAG("Application");
 
@@ -238,6 +239,8 @@ void Application::initializeRenderSystem() {
     
     // 2. 创建渲染上下文
     renderContext = std::make_unique<RenderContext>();
+    // 主窗口为BGRA8888，普通分辨率的显示器上使用LCD子像素抗锯齿让小字号更清晰
+    renderContext->getFontRenderer()->setSubpixelOrder(SubpixelOrder::RGB);
     
     // 3. 初始化窗口管理器
     windowManager = std::make_unique<WindowManager>();
@@ -245,7 +248,8 @@ void Application::initializeRenderSystem() {
 }
 
 void Application::initializeResourceSystem() {
-
+    // 上次运行留下的字形和整形结果，缩短首帧时间
+    FontRegistry::getInstance().enablePersistentCache(getResourcePath() + "/cache/text_cache.bin");
 }
 
 void Application::onSystemReady() {
@@ -40,6 +40,14 @@ void Choreographer::stop() {
         if (vsyncThread && vsyncThread->joinable()) {
             vsyncThread->join();
         }
+        nextFrameTimeNanos.store(0, std::memory_order_relaxed);
+
+        // 在锁外销毁，回调析构时可能再投递帧回调
+        std::queue<FrameCallback> dropped;
+        {
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            dropped.swap(frameCallbacks);
+        }
     }
 }
 
@@ -56,6 +64,10 @@ void Choreographer::vsyncLoop() {
     
     while (running) {
         auto frameStart = high_resolution_clock::now();
+        // VSync间隔未知时按后备帧率估计，供空闲处理计算截止时间
+        int64_t steadyStart = duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+        nextFrameTimeNanos.store(steadyStart + fallbackFrameIntervalNanos, std::memory_order_relaxed);
         
         if (vsyncEnabled) {
             surface->waitVSync();
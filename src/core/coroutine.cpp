@@ -0,0 +1,164 @@
+#include "core/coroutine.h"
+#include "core/choreographer.h"
+#include "core/logger.h"
+#include <new>
+
+LOG_TAG("Coroutine");
+
+namespace {
+constexpr size_t kFrameGranularity = 64;
+constexpr size_t kFrameClassCount = 16;  // 缓存1KB以内的帧
+constexpr size_t kMaxCachedFrames = 16;  // 每档每线程最多缓存的帧数
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+// 帧在哪个线程释放就进入哪个线程的缓存，跨线程结束的协程不需要同步
+struct FrameCache {
+    FreeFrame* lists[kFrameClassCount] = {};
+    size_t counts[kFrameClassCount] = {};
+
+    ~FrameCache() {
+        for (FreeFrame* frame : lists) {
+            while (frame) {
+                FreeFrame* next = frame->next;
+                ::operator delete(frame);
+                frame = next;
+            }
+        }
+    }
+};
+
+thread_local FrameCache frameCache;
+
+size_t frameClass(size_t size) {
+    return (size - 1) / kFrameGranularity;
+}
+
+// 恢复协程的回调：执行时恢复，未执行就被销毁（消息被移除、Handler已析构）时销毁协程帧
+// cancel为true时执行也只销毁帧，用于在协程所在线程上取消协程
+class CoroutineResumer {
+public:
+    explicit CoroutineResumer(AsyncHandle handle, bool cancel = false)
+        : handle(handle), cancel(cancel) {}
+    CoroutineResumer(CoroutineResumer&& other) noexcept
+        : handle(std::exchange(other.handle, {})), cancel(other.cancel) {}
+    CoroutineResumer& operator=(CoroutineResumer&&) = delete;
+
+    ~CoroutineResumer() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    void operator()() {
+        auto& owner = handle.promise().owner;
+        if (cancel || (owner && !owner->isAlive())) {
+            // 已取消，或已切换到其它Handler但所有者已经析构，帧在析构时销毁
+            return;
+        }
+        std::exchange(handle, {}).resume();
+    }
+
+private:
+    AsyncHandle handle;
+    bool cancel;
+};
+
+// 在协程当前所在的Handler线程上销毁协程帧，没有Handler时就地销毁
+void scheduleCancel(AsyncHandle handle) {
+    std::shared_ptr<HandlerAnchor> current = handle.promise().current;
+    if (!current) {
+        handle.destroy();
+        return;
+    }
+    current->post(CoroutineResumer(handle, true));
+}
+
+// 等待下一帧的协程，帧回调未执行就被丢弃（Choreographer停止）时取消协程
+// FrameCallback要求可复制，由回调的各个副本共享
+struct PendingFrame {
+    AsyncHandle handle;
+
+    explicit PendingFrame(AsyncHandle handle) : handle(handle) {}
+    PendingFrame(const PendingFrame&) = delete;
+    PendingFrame& operator=(const PendingFrame&) = delete;
+
+    ~PendingFrame() {
+        if (handle) {
+            scheduleCancel(handle);
+        }
+    }
+};
+} // namespace
+
+void* allocateCoroutineFrame(size_t size) {
+    size_t index = frameClass(size);
+    if (index >= kFrameClassCount) {
+        return ::operator new(size);
+    }
+    FreeFrame* frame = frameCache.lists[index];
+    if (frame) {
+        frameCache.lists[index] = frame->next;
+        frameCache.counts[index]--;
+        return frame;
+    }
+    return ::operator new((index + 1) * kFrameGranularity);
+}
+
+void freeCoroutineFrame(void* frame, size_t size) {
+    size_t index = frameClass(size);
+    if (index >= kFrameClassCount || frameCache.counts[index] >= kMaxCachedFrames) {
+        ::operator delete(frame);
+        return;
+    }
+    auto free = static_cast<FreeFrame*>(frame);
+    free->next = frameCache.lists[index];
+    frameCache.lists[index] = free;
+    frameCache.counts[index]++;
+}
+
+void AsyncTask::promise_type::unhandled_exception() noexcept {
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        LOGE("Unhandled exception in coroutine: %s", e.what());
+    } catch (...) {
+        LOGE("Unhandled exception in coroutine");
+    }
+}
+
+void scheduleResume(AsyncHandle handle, int64_t delayMillis, MessagePriority priority) {
+    std::shared_ptr<HandlerAnchor> current = handle.promise().current;
+    if (!current) {
+        LOGE("Coroutine has no handler to resume on, cancelled");
+        handle.destroy();
+        return;
+    }
+    // 投递失败时回调随参数销毁，协程帧也随之销毁
+    current->post(CoroutineResumer(handle), delayMillis, priority);
+}
+
+void HandlerResumeAwaiter::await_suspend(AsyncHandle handle) {
+    handle.promise().current = target;
+    scheduleResume(handle);
+}
+
+void FrameAwaiter::await_suspend(AsyncHandle handle) {
+    auto& choreographer = Choreographer::getInstance();
+    if (!choreographer.isRunning()) {
+        // 不会再有帧，取消而不是永远挂起
+        scheduleCancel(handle);
+        return;
+    }
+    // 帧回调在vsync线程上执行，只转交恢复，不在那里运行协程
+    choreographer.postFrameCallback(
+        [this, pending = std::make_shared<PendingFrame>(handle)](int64_t frameTimeNanos) {
+            AsyncHandle handle = std::exchange(pending->handle, {});
+            if (handle) {
+                this->frameTimeNanos = frameTimeNanos;
+                scheduleResume(handle, 0, MessagePriority::Frame);
+            }
+        });
+}
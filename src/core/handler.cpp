@@ -3,7 +3,29 @@
 
 LOG_TAG("Handler");
 
+bool HandlerAnchor::post(InlineCallback callback, int64_t delayMillis, MessagePriority priority) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!handler) {
+        return false;
+    }
+    Message* msg = Message::obtain();
+    msg->callback = std::move(callback);
+    msg->priority = priority;
+    handler->sendMessageDelayed(msg, delayMillis);
+    return true;
+}
+
+bool HandlerAnchor::isAlive() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return handler != nullptr;
+}
+
 Handler::~Handler() {
+    {
+        // 之后经anchor的投递都会失败，不会再有消息进入队列
+        std::lock_guard<std::mutex> lock(anchor->mutex);
+        anchor->handler = nullptr;
+    }
     if (looper && looper->getQueue()) {
         looper->getQueue()->removeMessagesForHandler(this);
     }
@@ -11,17 +33,17 @@ Handler::~Handler() {
 
 void Handler::sendMessage(Message* msg) {
     msg->when = 0;
-    looper->getQueue()->enqueueMessage(msg, this);
+    enqueueMessage(msg);
 }
 
 void Handler::sendMessageDelayed(Message* msg, int64_t delayMillis) {
     msg->when = delayMillis;
-    looper->getQueue()->enqueueMessage(msg, this);
+    enqueueMessage(msg);
 }
 
 void Handler::sendMessageAtTime(Message* msg, int64_t uptimeMillis) {
     msg->when = uptimeMillis;
-    looper->getQueue()->enqueueMessage(msg, this);
+    enqueueMessage(msg);
 }
 
 void Handler::sendEmptyMessage(int what) {
@@ -36,22 +58,48 @@ void Handler::sendEmptyMessageDelayed(int what, int64_t delayMillis) {
     sendMessageDelayed(std::move(msg), delayMillis);
 }
 
-void Handler::post(std::function<void()> r) {
+MessageToken Handler::post(InlineCallback r) {
     Message* msg = Message::obtain();
     msg->callback = std::move(r);
-    sendMessage(msg);
+    msg->when = 0;
+    return enqueueMessage(msg);
 }
 
-void Handler::postDelayed(std::function<void()> r, int64_t delayMillis) {
+MessageToken Handler::post(InlineCallback r, MessagePriority priority, bool async) {
+    Message* msg = Message::obtain();
+    msg->callback = std::move(r);
+    msg->when = 0;
+    msg->priority = priority;
+    msg->asynchronous = async;
+    return enqueueMessage(msg);
+}
+
+MessageToken Handler::postDelayed(InlineCallback r, int64_t delayMillis) {
     auto msg = Message::obtain();
     msg->callback = std::move(r);
     msg->when = delayMillis;
-    looper->getQueue()->enqueueMessage(std::move(msg), this);
+    return enqueueMessage(msg);
+}
+
+bool Handler::cancel(MessageToken token) {
+    return looper->getQueue()->cancel(token);
+}
+
+void Handler::removeMessages(int what) {
+    looper->getQueue()->removeMessages(this, what);
+}
+
+MessageToken Handler::enqueueMessage(Message* msg) {
+    if (asynchronous) {
+        msg->asynchronous = true;
+    }
+    if (msg->priority == MessagePriority::Default) {
+        msg->priority = priority;
+    }
+    return looper->getQueue()->enqueueMessage(msg, this);
 }
 
 void Handler::handleMessage(Message& message) {
-    LOGI("Handler processing message, callback present: %d", 
-         (int)(message.callback != nullptr));
     if (message.callback) {
         message.callback();
     }
@@ -0,0 +1,109 @@
+#include "core/looper_stats.h"
+#include "core/handler.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+LOG_TAG("LooperStats");
+
+namespace {
+static_assert(std::has_single_bit(LooperStats::kMaxEntries), "kMaxEntries must be a power of two");
+constexpr int kIndexBits = std::countr_zero(LooperStats::kMaxEntries);
+
+const char* typeName(const std::type_info* type) {
+    return type ? type->name() : "-";
+}
+} // namespace
+
+MessageStats& LooperStats::statsFor(const Message& msg) {
+    const std::type_info* handlerType = msg.target ? &typeid(*msg.target) : nullptr;
+    return findStats(handlerType, msg.callback.targetType(), msg.what);
+}
+
+MessageStats& LooperStats::findStats(const std::type_info* handlerType,
+                                     const std::type_info* callbackType, int what) {
+    uint64_t hash = reinterpret_cast<uintptr_t>(handlerType) ^
+                    (reinterpret_cast<uintptr_t>(callbackType) * 31) ^
+                    static_cast<uint32_t>(what);
+    size_t index = static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> (64 - kIndexBits));
+
+    // 只有Looper线程插入，条目从不删除，探测时遇到空位即可确定不存在
+    for (size_t i = 0; i < kMaxEntries; i++) {
+        Entry& entry = entries[(index + i) & (kMaxEntries - 1)];
+        if (!entry.used.load(std::memory_order_relaxed)) {
+            entry.stats.handlerType = handlerType;
+            entry.stats.callbackType = callbackType;
+            entry.stats.what = what;
+            entry.used.store(true, std::memory_order_release);
+            return entry.stats;
+        }
+        if (entry.stats.handlerType == handlerType && entry.stats.callbackType == callbackType &&
+            entry.stats.what == what) {
+            return entry.stats;
+        }
+    }
+    return overflow;
+}
+
+void LooperStats::record(MessageStats& stats, int64_t queueDelayNanos, int64_t runNanos) {
+    stats.queueDelay.record(queueDelayNanos);
+    stats.runTime.record(runNanos);
+    if (runNanos > stats.maxRunNanos.load(std::memory_order_relaxed)) {
+        stats.maxRunNanos.store(runNanos, std::memory_order_relaxed);
+    }
+    if (runNanos > slowThresholdNanos.load(std::memory_order_relaxed)) {
+        reportSlowMessage(stats, queueDelayNanos, runNanos);
+    }
+}
+
+void LooperStats::reportSlowMessage(const MessageStats& stats, int64_t queueDelayNanos,
+                                    int64_t runNanos) {
+    SlowMessageCallback callback;
+    {
+        // 在锁外回调，回调中可以重新设置
+        std::lock_guard<std::mutex> lock(slowMutex);
+        callback = slowCallback;
+    }
+    if (callback) {
+        callback(SlowMessageInfo{stats.handlerType, stats.callbackType, stats.what,
+                                 queueDelayNanos, runNanos});
+    }
+}
+
+void LooperStats::setSlowMessageCallback(int64_t thresholdNanos, SlowMessageCallback callback) {
+    std::lock_guard<std::mutex> lock(slowMutex);
+    slowThresholdNanos.store(callback ? thresholdNanos : INT64_MAX, std::memory_order_relaxed);
+    slowCallback = std::move(callback);
+}
+
+void LooperStats::reset() {
+    for (Entry& entry : entries) {
+        entry.stats.queueDelay.reset();
+        entry.stats.runTime.reset();
+        entry.stats.maxRunNanos.store(0, std::memory_order_relaxed);
+    }
+    overflow.queueDelay.reset();
+    overflow.runTime.reset();
+    overflow.maxRunNanos.store(0, std::memory_order_relaxed);
+}
+
+void LooperStats::dump() const {
+    std::vector<const MessageStats*> sorted;
+    forEach([&](const MessageStats& stats) { sorted.push_back(&stats); });
+    std::sort(sorted.begin(), sorted.end(), [](const MessageStats* a, const MessageStats* b) {
+        return a->runTime.getCount() > b->runTime.getCount();
+    });
+
+    LOGI("Looper message stats: %zu kinds", sorted.size());
+    for (const MessageStats* stats : sorted) {
+        LOGI("%s %s what=%d count=%llu delay p50/p99=%llu/%lluus run p50/p99=%llu/%lluus max=%lldus",
+             typeName(stats->handlerType), typeName(stats->callbackType), stats->what,
+             static_cast<unsigned long long>(stats->runTime.getCount()),
+             static_cast<unsigned long long>(stats->queueDelay.getPercentileMicros(0.5)),
+             static_cast<unsigned long long>(stats->queueDelay.getPercentileMicros(0.99)),
+             static_cast<unsigned long long>(stats->runTime.getPercentileMicros(0.5)),
+             static_cast<unsigned long long>(stats->runTime.getPercentileMicros(0.99)),
+             static_cast<long long>(stats->maxRunNanos.load(std::memory_order_relaxed) / 1000));
+    }
+}
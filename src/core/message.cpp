@@ -1,32 +1,80 @@
 #include "core/message.h"
 #include "core/handler.h"
 #include "core/logger.h"
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 #include <thread>
+#include <utility>
 
 
 LOG_TAG("Message");
 
 // Message Pool 实现
+// 每个线程先用自己的缓存，空了或满了才与全局池成批交换，稳态下取还消息不加锁
 namespace
 {
 std::vector<Message*> messagePool;
 std::mutex poolMutex;
-constexpr size_t MAX_POOL_SIZE = 50;
+constexpr size_t LOCAL_POOL_SIZE = 64;
+constexpr size_t POOL_BATCH = 32;  // 线程缓存与全局池之间一次搬运的数量
+
+// 需持有poolMutex
+// 消息一经分配就不再释放：消息回收后令牌仍可能被用来取消，cancel要读取其generation
+// 池的大小停留在同时存在的消息数的峰值
+void releaseToPool(Message* const* msgs, size_t count)
+{
+  messagePool.insert(messagePool.end(), msgs, msgs + count);
+}
+
+struct LocalPool {
+  std::vector<Message*> messages;
+
+  LocalPool() { messages.reserve(LOCAL_POOL_SIZE); }
+
+  // 线程退出时把缓存归还全局池
+  ~LocalPool()
+  {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    releaseToPool(messages.data(), messages.size());
+  }
+};
+
+thread_local LocalPool localPool;
 
 constexpr int64_t millisToNanos(int64_t ms) {
     return ms * 1000000;
 }
+
+// 没有帧和定时消息约束时，一轮空闲处理最多占用的时间
+constexpr int64_t IDLE_BUDGET_NANOS = millisToNanos(16);
+
+// 消息持续到来时检查文件描述符的最长间隔
+constexpr int64_t FD_POLL_INTERVAL_NANOS = millisToNanos(1);
+
+// 低优先级通道队首等待超过此时间后先于高优先级执行，防止饿死；输入通道最高，不需要
+constexpr int64_t STARVATION_LIMIT_NANOS[kMessagePriorityCount] = {
+    0,
+    millisToNanos(33),
+    millisToNanos(100),
+    millisToNanos(500)
+};
 } // namespace
 
 Message* Message::obtain()
 {
-  std::lock_guard<std::mutex> lock(poolMutex);
-  if (messagePool.empty()) {
+  auto& local = localPool.messages;
+  if (local.empty()) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    size_t count = std::min(POOL_BATCH, messagePool.size());
+    local.insert(local.end(), messagePool.end() - count, messagePool.end());
+    messagePool.resize(messagePool.size() - count);
+  }
+  if (local.empty()) {
     return new Message();
   }
-  Message* msg = messagePool.back();
-  messagePool.pop_back();
+  Message* msg = local.back();
+  local.pop_back();
   return msg;
 }
 
@@ -35,146 +83,555 @@ void Message::recycle(Message* msg)
   if (!msg)
     return;
   msg->reset();
-  std::lock_guard<std::mutex> lock(poolMutex);
-  if (messagePool.size() < MAX_POOL_SIZE) {
-    messagePool.push_back(msg);
-  } else {
-    delete msg;
+  auto& local = localPool.messages;
+  if (local.size() >= LOCAL_POOL_SIZE) {
+    // 消息通常在生产者线程取出、在Looper线程回收，多出的成批还给全局池
+    std::lock_guard<std::mutex> lock(poolMutex);
+    releaseToPool(local.data() + local.size() - POOL_BATCH, POOL_BATCH);
+    local.resize(local.size() - POOL_BATCH);
   }
+  local.push_back(msg);
 }
 
 void Message::clearPool()
 {
+  // 只把本线程的缓存还给全局池，消息本身不释放，见releaseToPool
+  auto& local = localPool.messages;
   std::lock_guard<std::mutex> lock(poolMutex);
-  messagePool.clear();
+  releaseToPool(local.data(), local.size());
+  local.clear();
 }
 
 // MessageQueue 实现
-void MessageQueue::post(std::function<void()> message)
+MessageQueue::MessageQueue()
+{
+  timers.reset(getCurrentTimeNanos() / 1000000);
+}
+
+MessageToken MessageQueue::post(InlineCallback message)
 {
   Message* msg = Message::obtain();
   msg->callback = std::move(message);
   msg->when = getCurrentTimeNanos();
-  messageQueue.push(msg);
-  messageAvailable.notify_one();
+  return pushMessage(msg);
 }
 
-void MessageQueue::postDelayed(std::function<void()> message,
-                               int64_t delayMillis)
+MessageToken MessageQueue::postDelayed(InlineCallback message,
+                                       int64_t delayMillis)
 {
   Message* msg = Message::obtain();
   msg->callback = std::move(message);
   msg->when = getCurrentTimeNanos() + millisToNanos(delayMillis);
-  messageQueue.push(msg);
-  messageAvailable.notify_one();
+  return pushMessage(msg);
 }
 
-void MessageQueue::enqueueMessage(Message* msg, Handler* handler)
+MessageToken MessageQueue::enqueueMessage(Message* msg, Handler* handler)
 {
-  std::lock_guard<std::mutex> lock(mutex);
   msg->target = handler;
   if (msg->when == 0) {
     msg->when = getCurrentTimeNanos();
   } else {
     msg->when = getCurrentTimeNanos() + millisToNanos(msg->when);
   }
-  messageQueue.push(msg);
-  messageAvailable.notify_one();
+  return pushMessage(msg);
 }
 
-void MessageQueue::processNextMessage()
+MessageToken MessageQueue::pushMessage(Message* msg)
 {
-  std::unique_lock<std::mutex> lock(mutex);
+  if (msg->priority == MessagePriority::Default) {
+    msg->priority = MessagePriority::Normal;
+  }
+  // 入队后消息随时可能执行并回收，令牌必须在此之前生成
+  MessageToken token{msg, msg->generation.load(std::memory_order_relaxed)};
+  inbox.push(msg);
+  wake();
+  return token;
+}
 
-  while (!quitting) {
-    if (!messageQueue.empty()) {
-      Message* msg = messageQueue.top();
-      auto now = getCurrentTimeNanos();
+void MessageQueue::wake()
+{
+  // 消费者没有睡眠时不做系统调用，投递路径只有一次原子交换和一次读取
+  if (sleeping.load(std::memory_order_seq_cst)) {
+    poller.wake();
+  }
+}
 
-      if (msg->when <= now) {
-        messageQueue.pop();
+void MessageQueue::drainInbox()
+{
+  int64_t now = getCurrentTimeNanos();
+  while (Message* msg = inbox.pop()) {
+    if (msg->cancelled) {
+      // 还在收件箱中时就被取消，回调已释放
+      Message::recycle(msg);
+      continue;
+    }
+    msg->sequence = nextSequence++;
+    indexMessage(msg);
+    if (msg->when > now) {
+      // 取出期间可能已经过了when，重新读一次时钟，避免刚投递的消息被推迟一个刻度
+      now = getCurrentTimeNanos();
+    }
+    if (msg->when > now) {
+      timers.insert(msg);
+    } else {
+      pushReady(msg);
+    }
+  }
+}
 
-        lock.unlock();
-        if (msg->callback) {
-          msg->callback();
-        } else if (msg->target) {
-          msg->target->handleMessage(*msg);
-        }
+void MessageQueue::advanceTimers(int64_t now)
+{
+  timers.advance(now / 1000000, expiredTimers);
+  for (Message* msg : expiredTimers) {
+    pushReady(msg);
+  }
+  expiredTimers.clear();
+}
 
-        Message::recycle(msg);
-        lock.lock();
-        continue;
-      }
+void MessageQueue::pushReady(Message* msg)
+{
+  Lane& lane = lanes[static_cast<int>(msg->priority)];
+  if (msg->asynchronous) {
+    lane.async.push(msg);
+  } else {
+    lane.sync.push(msg);
+  }
+}
 
-      // 等待到执行时间
-      auto waitTime = std::chrono::nanoseconds(msg->when - now);
-      auto waitUntil = std::chrono::steady_clock::now() + waitTime;
-      messageAvailable.wait_until(lock, waitUntil);
-      continue;
+Message* MessageQueue::peekLane(Lane& lane, const SyncBarrier* barrier)
+{
+  // 顺便回收堆顶的墓碑
+  for (MessageHeap* heap : {&lane.sync, &lane.async}) {
+    while (!heap->empty() && heap->top()->cancelled) {
+      Message::recycle(heap->top());
+      heap->pop();
     }
+  }
 
-    // 队列为空，执行空闲处理
-    bool keepWaiting = true;
-    for (auto it = idleHandlers.begin(); it != idleHandlers.end();) {
-      bool keep = (*it)();
-      if (!keep) {
-        it = idleHandlers.erase(it);
-      } else {
-        ++it;
-      }
-      keepWaiting &= keep;
+  Message* sync = lane.sync.empty() ? nullptr : lane.sync.top();
+  if (sync && barrier &&
+      (barrier->when < sync->when ||
+       (barrier->when == sync->when && barrier->sequence < sync->sequence))) {
+    sync = nullptr;
+  }
+  Message* async = lane.async.empty() ? nullptr : lane.async.top();
+  if (async && (!sync || MessageComparer()(sync, async))) {
+    return async;
+  }
+  return sync;
+}
+
+Message* MessageQueue::nextReadyMessage(int64_t now)
+{
+  // 只有最早的屏障起作用，排在它之前的同步消息照常执行
+  const SyncBarrier* barrier = nullptr;
+  for (const SyncBarrier& candidate : barriers) {
+    if (!barrier || candidate.when < barrier->when ||
+        (candidate.when == barrier->when && candidate.sequence < barrier->sequence)) {
+      barrier = &candidate;
     }
+  }
 
-    if (keepWaiting && !quitting) {
-      messageAvailable.wait(lock);
+  // 取最高优先级通道的队首；更低的通道等待过久时插入一条，超时最多的优先
+  // 连续两次不会都给饿死的通道，持续过载时高优先级通道至少分到一半
+  int chosen = -1;
+  Message* msg = nullptr;
+  int64_t mostOverdue = 0;
+  for (int i = 0; i < kMessagePriorityCount; i++) {
+    Message* head = peekLane(lanes[i], barrier);
+    if (!head) {
+      continue;
+    }
+    if (!msg) {
+      chosen = i;
+      msg = head;
+      if (lastPickStarved) {
+        break;
+      }
+      continue;
+    }
+    int64_t overdue = now - head->when - STARVATION_LIMIT_NANOS[i];
+    if (overdue > mostOverdue) {
+      mostOverdue = overdue;
+      chosen = i;
+      msg = head;
     }
   }
+  if (!msg) {
+    return nullptr;
+  }
+  lastPickStarved = mostOverdue > 0;
 
-  // 如果是退出状态，确保清理所有剩余消息
-  if (quitting) {
-    while (!messageQueue.empty()) {
-      Message* msg = messageQueue.top();
-      messageQueue.pop();
-      
-      Message::recycle(msg);
+  Lane& lane = lanes[chosen];
+  if (!lane.async.empty() && lane.async.top() == msg) {
+    lane.async.pop();
+  } else {
+    lane.sync.pop();
+  }
+  lane.latency.record(now - msg->when);
+  unindexMessage(msg);
+  msg->generation.fetch_add(1, std::memory_order_relaxed);
+  return msg;
+}
+
+bool MessageQueue::hasPendingMessages() const
+{
+  for (const Lane& lane : lanes) {
+    if (!lane.sync.empty() || !lane.async.empty()) {
+      return true;
     }
   }
+  return !timers.empty();
 }
 
-void MessageQueue::removeMessagesForHandler(Handler* handler)
+void MessageQueue::indexMessage(Message* msg)
+{
+  if (!msg->target) {
+    return;
+  }
+  Message*& head = msg->target->pendingMessages[msg->what];
+  msg->handlerPrev = nullptr;
+  msg->handlerNext = head;
+  if (head) {
+    head->handlerPrev = msg;
+  }
+  head = msg;
+  msg->indexed = true;
+}
+
+void MessageQueue::unindexMessage(Message* msg)
+{
+  if (!msg->indexed) {
+    return;
+  }
+  if (msg->handlerPrev) {
+    msg->handlerPrev->handlerNext = msg->handlerNext;
+  } else {
+    // 链表空了也保留表项，见Handler::pendingMessages
+    msg->target->pendingMessages[msg->what] = msg->handlerNext;
+  }
+  if (msg->handlerNext) {
+    msg->handlerNext->handlerPrev = msg->handlerPrev;
+  }
+  msg->handlerPrev = nullptr;
+  msg->handlerNext = nullptr;
+  msg->indexed = false;
+}
+
+void MessageQueue::dropMessage(Message* msg)
+{
+  // 调用方已解除索引
+  msg->generation.fetch_add(1, std::memory_order_relaxed);
+  if (msg->callback) {
+    droppedCallbacks.push_back(std::move(msg->callback));
+  }
+  if (timers.contains(msg)) {
+    timers.remove(msg);
+    Message::recycle(msg);
+    return;
+  }
+  // 在就绪堆或收件箱中的留下墓碑，回调在调用方解锁后释放
+  msg->cancelled = true;
+  msg->target = nullptr;
+}
+
+void MessageQueue::destroyDroppedCallbacks(std::unique_lock<std::mutex>& lock)
+{
+  std::vector<InlineCallback> dropped;
+  dropped.swap(droppedCallbacks);
+  lock.unlock();
+  dropped.clear();
+}
+
+void MessageQueue::dropMessageList(Message* head)
+{
+  while (head) {
+    Message* next = head->handlerNext;
+    head->handlerPrev = nullptr;
+    head->handlerNext = nullptr;
+    head->indexed = false;
+    dropMessage(head);
+    head = next;
+  }
+}
+
+bool MessageQueue::cancel(MessageToken token)
+{
+  if (!token) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  // 先取出收件箱；生产者尚未链接完成的消息仍留在收件箱中，没有索引，只留下墓碑
+  drainInbox();
+  Message* msg = token.message;
+  if (msg->generation.load(std::memory_order_relaxed) != token.generation) {
+    return false;
+  }
+  unindexMessage(msg);
+  dropMessage(msg);
+  destroyDroppedCallbacks(lock);
+  return true;
+}
+
+int MessageQueue::postSyncBarrier()
 {
   std::lock_guard<std::mutex> lock(mutex);
-  std::vector<Message*> temp;
+  // 先取出已投递的消息，保证它们排在屏障之前
+  drainInbox();
+  int token = ++nextBarrierToken;
+  barriers.push_back({token, getCurrentTimeNanos(), nextSequence++});
+  return token;
+}
 
-  while (!messageQueue.empty()) {
-    Message* msg = messageQueue.top();
-    messageQueue.pop();
+void MessageQueue::removeSyncBarrier(int token)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(barriers.begin(), barriers.end(),
+                           [token](const SyncBarrier& barrier) { return barrier.token == token; });
+    if (it == barriers.end()) {
+      LOGE("Sync barrier %d does not exist", token);
+      return;
+    }
+    barriers.erase(it);
+  }
+  // 被挡住的同步消息可能已经到期，唤醒Looper重新挑选
+  wake();
+}
+
+void MessageQueue::waitForMessages(std::unique_lock<std::mutex>& lock, int64_t when)
+{
+  // 先声明要睡眠再检查收件箱，生产者要么被这里看到，要么看到sleeping后来唤醒
+  sleeping.store(true, std::memory_order_seq_cst);
+  if (inbox.isEmpty() && !quitting.load(std::memory_order_acquire)) {
+    poller.wait(lock, when);
+  }
+  sleeping.store(false, std::memory_order_relaxed);
+}
+
+int64_t MessageQueue::getIdleDeadline(int64_t now)
+{
+  int64_t deadline = now + IDLE_BUDGET_NANOS;
+  if (frameTimeProvider) {
+    int64_t frameTime = frameTimeProvider();
+    if (frameTime > now) {
+      deadline = std::min(deadline, frameTime);
+    }
+  }
+  if (!timers.empty()) {
+    deadline = std::min(deadline, timers.nextTick() * 1000000);
+  }
+  return deadline;
+}
+
+bool MessageQueue::hasIdleHandlers()
+{
+  std::lock_guard<std::mutex> lock(idleMutex);
+  return !idleHandlers.empty();
+}
+
+bool MessageQueue::hasReadyMessages() const
+{
+  for (const Lane& lane : lanes) {
+    if (!lane.sync.empty() || !lane.async.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool MessageQueue::runIdleHandlers(const IdleDeadline& idleDeadline)
+{
+  // 取出后在锁外执行，空闲处理中可以投递消息或增删空闲处理
+  std::vector<IdleEntry> pending;
+  {
+    std::lock_guard<std::mutex> lock(idleMutex);
+    pending.swap(idleHandlers);
+    runningIdleHandlers = true;
+  }
+
+  // 从上次停下的位置轮转，截止时间到了就停，保证每个处理都有机会执行
+  size_t count = pending.size();
+  size_t start = count ? idleCursor % count : 0;
+  std::vector<bool> removed(count, false);
+  bool moreWork = false;
+  size_t ran = 0;
+  while (ran < count) {
+    if (!idleDeadline.hasTimeRemaining()) {
+      moreWork = true;
+      break;
+    }
+    if (idleRemovalPending.load(std::memory_order_acquire)) {
+      applyIdleRemovals(pending, removed);
+    }
+    size_t index = (start + ran) % count;
+    if (removed[index]) {
+      ran++;
+      continue;
+    }
+    IdleResult result = pending[index].handler(idleDeadline);
+    if (result == IdleResult::Remove) {
+      removed[index] = true;
+    } else if (result == IdleResult::Yield) {
+      moreWork = true;
+    }
+    ran++;
+  }
+
+  // 本轮执行期间调用removeIdleHandler移除的处理
+  applyIdleRemovals(pending, removed);
+
+  // 下一轮从第一个没执行的处理开始，移除的处理不占位置
+  size_t next = (start + ran) % std::max<size_t>(count, 1);
+  size_t cursor = 0;
+  std::vector<IdleEntry> kept;
+  kept.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    if (i == next) {
+      cursor = kept.size();
+    }
+    if (!removed[i]) {
+      kept.push_back(std::move(pending[i]));
+    }
+  }
+  idleCursor = cursor;
+
+  std::lock_guard<std::mutex> lock(idleMutex);
+  // 合并前再检查一次，移除和合并在同一把锁内，不会漏掉
+  for (const std::type_info* type : pendingIdleRemovals) {
+    kept.erase(std::remove_if(kept.begin(), kept.end(),
+                              [type](const IdleEntry& entry) { return *entry.type == *type; }),
+               kept.end());
+  }
+  pendingIdleRemovals.clear();
+  idleRemovalPending.store(false, std::memory_order_relaxed);
+  runningIdleHandlers = false;
+  idleCursor = std::min(idleCursor, kept.size());
+  kept.insert(kept.end(),
+              std::make_move_iterator(idleHandlers.begin()),
+              std::make_move_iterator(idleHandlers.end()));
+  idleHandlers.swap(kept);
+  return moreWork;
+}
+
+void MessageQueue::applyIdleRemovals(const std::vector<IdleEntry>& entries, std::vector<bool>& removed)
+{
+  std::lock_guard<std::mutex> lock(idleMutex);
+  for (const std::type_info* type : pendingIdleRemovals) {
+    for (size_t i = 0; i < entries.size(); i++) {
+      if (*entries[i].type == *type) {
+        removed[i] = true;
+      }
+    }
+  }
+  pendingIdleRemovals.clear();
+  idleRemovalPending.store(false, std::memory_order_relaxed);
+}
+
+void MessageQueue::processNextMessage()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (!quitting.load(std::memory_order_acquire)) {
+    drainInbox();
+    int64_t now = getCurrentTimeNanos();
+    advanceTimers(now);
+
+    // 有就绪消息时不会进入wait，定期不等待地检查一次描述符，输入不会被消息洪流饿死
+    if (now - lastFdPollNanos >= FD_POLL_INTERVAL_NANOS) {
+      lastFdPollNanos = now;
+      poller.poll(lock);
+    }
+
+    if (Message* msg = nextReadyMessage(now)) {
+#if LOOPER_STATS_ENABLED
+      // 执行前取条目，执行中target可能被析构
+      MessageStats& messageStats = stats.statsFor(*msg);
+#endif
+      lock.unlock();
+#if LOOPER_STATS_ENABLED
+      // 执行时间从回调开始算起，不含选取消息和查找条目的开销
+      int64_t start = getCurrentTimeNanos();
+#endif
+      if (msg->callback) {
+        msg->callback();
+      } else if (msg->target) {
+        msg->target->handleMessage(*msg);
+      }
+#if LOOPER_STATS_ENABLED
+      stats.record(messageStats, start - msg->when, getCurrentTimeNanos() - start);
+#endif
 
-    if (msg->target != handler) {
-      temp.push_back(msg);
-    } else {
       Message::recycle(msg);
+      lock.lock();
+      continue;
+    }
+
+    // 没有到期的消息，在下一帧或下一个定时消息之前执行空闲处理；被屏障挡住时帧即将到来，不执行
+    bool idleWaiting = now < idleResumeNanos;
+    if (!idleWaiting && !hasReadyMessages() && inbox.isEmpty() && hasIdleHandlers()) {
+      IdleDeadline deadline{getIdleDeadline(getCurrentTimeNanos()), &inbox, inbox.peekHead()};
+      lock.unlock();
+      bool moreWork = runIdleHandlers(deadline);
+      lock.lock();
+
+      if (moreWork) {
+        // 被新消息打断的先处理消息，处理完就继续；否则不在本段空闲时间内重入
+        if (!deadline.hasPendingMessages()) {
+          int64_t end = getCurrentTimeNanos();
+          // 截止时间已过时等到下一帧开始或下一个定时消息到期，而不是已经过去的截止时间
+          idleResumeNanos = end < deadline.deadlineNanos ? deadline.deadlineNanos : getIdleDeadline(end);
+        }
+        continue;
+      }
+    }
+
+    // 等待新消息，或到时间轮下一次需要推进的时刻，或空闲工作可以继续的时刻
+    int64_t wakeTime = timers.empty() ? -1 : timers.nextTick() * 1000000;
+    if (idleWaiting && hasIdleHandlers()) {
+      wakeTime = wakeTime < 0 ? idleResumeNanos : std::min(wakeTime, idleResumeNanos);
     }
+    waitForMessages(lock, wakeTime);
   }
 
-  for (Message* msg : temp) {
-    messageQueue.push(msg);
+  // 如果是退出状态，确保清理所有剩余消息
+  clearMessages();
+  destroyDroppedCallbacks(lock);
+}
+
+void MessageQueue::removeMessagesForHandler(Handler* handler)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  drainInbox();
+  for (auto& entry : handler->pendingMessages) {
+    dropMessageList(entry.second);
   }
+  handler->pendingMessages.clear();
+  destroyDroppedCallbacks(lock);
+}
+
+void MessageQueue::removeMessages(Handler* handler, int what)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  drainInbox();
+  auto it = handler->pendingMessages.find(what);
+  if (it != handler->pendingMessages.end()) {
+    Message* head = std::exchange(it->second, nullptr);
+    dropMessageList(head);
+  }
+  destroyDroppedCallbacks(lock);
 }
 
 void MessageQueue::quit()
 {
     LOGI("MessageQueue quitting...");
     
-    {
-        std::lock_guard<std::mutex> lock(mutex);
-        LOGI("Setting quit flag");
-        quitting = true;
-    }
-    
-    // 通知所有等待的线程
+    LOGI("Setting quit flag");
+    quitting.store(true, std::memory_order_seq_cst);
+
+    // 无条件唤醒，Looper线程检查标志后才会睡眠，不会错过
     LOGI("Notifying waiting threads");
-    messageAvailable.notify_all();
+    poller.wake();
     
     // 等待所有正在处理的消息完成
     LOGI("Yielding for pending messages");
@@ -189,28 +646,85 @@ void MessageQueue::quit()
 
 void MessageQueue::removeAllMessages()
 {
-  std::lock_guard<std::mutex> lock(mutex);
-  while (!messageQueue.empty()) {
-    Message* msg = messageQueue.top();
-    messageQueue.pop();
+  std::unique_lock<std::mutex> lock(mutex);
+  clearMessages();
+  destroyDroppedCallbacks(lock);
+}
+
+void MessageQueue::clearMessages()
+{
+  drainInbox();
+  auto release = [this](Message* msg) {
+    unindexMessage(msg);
+    msg->generation.fetch_add(1, std::memory_order_relaxed);
+    if (msg->callback) {
+      droppedCallbacks.push_back(std::move(msg->callback));
+    }
     Message::recycle(msg);
+  };
+  for (Lane& lane : lanes) {
+    for (MessageHeap* heap : {&lane.sync, &lane.async}) {
+      while (!heap->empty()) {
+        Message* msg = heap->top();
+        heap->pop();
+        release(msg);
+      }
+    }
+  }
+  barriers.clear();
+  timers.takeAll(expiredTimers);
+  for (Message* msg : expiredTimers) {
+    release(msg);
   }
+  expiredTimers.clear();
+}
+
+bool MessageQueue::addFd(int fd, uint32_t events, Poller::FdCallback callback)
+{
+  return poller.addFd(fd, events, std::move(callback));
+}
+
+bool MessageQueue::removeFd(int fd)
+{
+  return poller.removeFd(fd);
 }
 
 void MessageQueue::addIdleHandler(IdleHandler handler)
 {
-  std::lock_guard<std::mutex> lock(mutex);
-  idleHandlers.push_back(std::move(handler));
+  const std::type_info* type = &handler.target_type();
+  DeadlineIdleHandler wrapped = [handler = std::move(handler)](const IdleDeadline&) {
+    return handler() ? IdleResult::Keep : IdleResult::Remove;
+  };
+  std::lock_guard<std::mutex> lock(idleMutex);
+  idleHandlers.push_back({std::move(wrapped), type});
+}
+
+void MessageQueue::addIdleHandler(DeadlineIdleHandler handler)
+{
+  const std::type_info* type = &handler.target_type();
+  std::lock_guard<std::mutex> lock(idleMutex);
+  idleHandlers.push_back({std::move(handler), type});
 }
 
 void MessageQueue::removeIdleHandler(const IdleHandler& handler)
 {
-  std::lock_guard<std::mutex> lock(mutex);
+  std::lock_guard<std::mutex> lock(idleMutex);
   auto it = std::remove_if(idleHandlers.begin(), idleHandlers.end(),
-                           [&handler](const auto& h) {
-                             return h.target_type() == handler.target_type();
+                           [&handler](const IdleEntry& entry) {
+                             return *entry.type == handler.target_type();
                            });
   idleHandlers.erase(it, idleHandlers.end());
+  // 正在执行的一轮已把处理取出，记下来由runIdleHandlers移除
+  if (runningIdleHandlers) {
+    pendingIdleRemovals.push_back(&handler.target_type());
+    idleRemovalPending.store(true, std::memory_order_release);
+  }
+}
+
+void MessageQueue::setFrameTimeProvider(std::function<int64_t()> provider)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  frameTimeProvider = std::move(provider);
 }
 
 int64_t MessageQueue::getCurrentTimeNanos()
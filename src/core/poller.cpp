@@ -0,0 +1,235 @@
+#include "core/poller.h"
+#include "core/logger.h"
+#include <chrono>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+LOG_TAG("Poller");
+
+namespace {
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#ifdef __linux__
+constexpr int kMaxEvents = 16;
+
+uint32_t toEpollEvents(uint32_t events) {
+    uint32_t result = 0;
+    if (events & Poller::EVENT_INPUT) {
+        result |= EPOLLIN;
+    }
+    if (events & Poller::EVENT_OUTPUT) {
+        result |= EPOLLOUT;
+    }
+    // EPOLLERR和EPOLLHUP总会上报，不需要注册
+    return result;
+}
+
+uint32_t fromEpollEvents(uint32_t events) {
+    uint32_t result = 0;
+    if (events & EPOLLIN) {
+        result |= Poller::EVENT_INPUT;
+    }
+    if (events & EPOLLOUT) {
+        result |= Poller::EVENT_OUTPUT;
+    }
+    if (events & EPOLLERR) {
+        result |= Poller::EVENT_ERROR;
+    }
+    if (events & EPOLLHUP) {
+        result |= Poller::EVENT_HANGUP;
+    }
+    return result;
+}
+#endif
+} // namespace
+
+#ifdef __linux__
+Poller::Poller(std::mutex& mutex) : queueMutex(mutex) {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        LOGE("Failed to create epoll/eventfd: %s", strerror(errno));
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) != 0) {
+        LOGE("Failed to watch wake eventfd: %s", strerror(errno));
+    }
+}
+
+Poller::~Poller() {
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+void Poller::wait(std::unique_lock<std::mutex>& lock, int64_t deadlineNanos) {
+    if (epollFd < 0) {
+        // 创建失败时仍能按时间等待，只是没有描述符
+        if (deadlineNanos < 0) {
+            wakeCondition.wait(lock);
+        } else {
+            wakeCondition.wait_for(lock, std::chrono::nanoseconds(deadlineNanos - nowNanos()));
+        }
+        return;
+    }
+
+    int timeoutMillis = -1;
+    if (deadlineNanos >= 0) {
+        // 向上取整，避免提前醒来再空转一次
+        int64_t remaining = deadlineNanos - nowNanos();
+        timeoutMillis = remaining <= 0 ? 0 : static_cast<int>((remaining + 999999) / 1000000);
+    }
+
+    lock.unlock();
+    epoll_event events[kMaxEvents];
+    int count = epoll_wait(epollFd, events, kMaxEvents, timeoutMillis);
+    if (count < 0 && errno != EINTR) {
+        LOGE("epoll_wait failed: %s", strerror(errno));
+    }
+    dispatchEvents(events, count);
+    lock.lock();
+}
+
+void Poller::poll(std::unique_lock<std::mutex>& lock) {
+    if (epollFd < 0 || fdCount.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    epoll_event events[kMaxEvents];
+    int count = epoll_wait(epollFd, events, kMaxEvents, 0);
+    if (count <= 0) {
+        return;
+    }
+    // 同时取到的唤醒事件可以丢弃，调用方睡眠前会重新检查收件箱
+    lock.unlock();
+    dispatchEvents(events, count);
+    lock.lock();
+}
+
+void Poller::dispatchEvents(const epoll_event* events, int count) {
+    for (int i = 0; i < count; i++) {
+        int fd = events[i].data.fd;
+        if (fd == wakeFd) {
+            uint64_t value;
+            while (read(wakeFd, &value, sizeof(value)) > 0) {
+            }
+        } else {
+            dispatchFd(fd, fromEpollEvents(events[i].events));
+        }
+    }
+}
+
+void Poller::wake() {
+    if (wakeFd < 0) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        wakeCondition.notify_one();
+        return;
+    }
+    uint64_t one = 1;
+    // 计数器已满时写入失败，但此时必然有未处理的唤醒
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+bool Poller::addFd(int fd, uint32_t events, FdCallback callback) {
+    if (epollFd < 0 || fd < 0 || !callback) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(fdMutex);
+    epoll_event event{};
+    event.events = toEpollEvents(events);
+    event.data.fd = fd;
+    bool exists = fdCallbacks.count(fd) != 0;
+    if (epoll_ctl(epollFd, exists ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) != 0) {
+        LOGE("Failed to watch fd %d: %s", fd, strerror(errno));
+        return false;
+    }
+    fdCallbacks[fd] = std::make_shared<FdCallback>(std::move(callback));
+    fdCount.store(fdCallbacks.size(), std::memory_order_relaxed);
+    return true;
+}
+
+bool Poller::removeFd(int fd) {
+    std::lock_guard<std::mutex> lock(fdMutex);
+    auto it = fdCallbacks.find(fd);
+    if (it == fdCallbacks.end()) {
+        return false;
+    }
+    fdCallbacks.erase(it);
+    fdCount.store(fdCallbacks.size(), std::memory_order_relaxed);
+    // 描述符可能已被调用方关闭，此时内核已自动移除
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    return true;
+}
+
+void Poller::dispatchFd(int fd, uint32_t events) {
+    std::shared_ptr<FdCallback> callback;
+    {
+        std::lock_guard<std::mutex> lock(fdMutex);
+        auto it = fdCallbacks.find(fd);
+        if (it == fdCallbacks.end()) {
+            // 同一批事件中已被前面的回调注销
+            return;
+        }
+        callback = it->second;
+    }
+
+    if ((*callback)(fd, events)) {
+        return;
+    }
+
+    // 回调期间可能重新注册了同一描述符，只注销本次执行的这个
+    std::lock_guard<std::mutex> lock(fdMutex);
+    auto it = fdCallbacks.find(fd);
+    if (it != fdCallbacks.end() && it->second == callback) {
+        fdCallbacks.erase(it);
+        fdCount.store(fdCallbacks.size(), std::memory_order_relaxed);
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+#else
+Poller::Poller(std::mutex& mutex) : queueMutex(mutex) {
+}
+
+Poller::~Poller() = default;
+
+void Poller::wait(std::unique_lock<std::mutex>& lock, int64_t deadlineNanos) {
+    if (deadlineNanos < 0) {
+        wakeCondition.wait(lock);
+    } else {
+        wakeCondition.wait_for(lock, std::chrono::nanoseconds(deadlineNanos - nowNanos()));
+    }
+}
+
+void Poller::poll(std::unique_lock<std::mutex>&) {
+}
+
+void Poller::wake() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    wakeCondition.notify_one();
+}
+
+bool Poller::addFd(int, uint32_t, FdCallback) {
+    LOGE("File descriptor watching is not supported on this platform");
+    return false;
+}
+
+bool Poller::removeFd(int) {
+    return false;
+}
+#endif
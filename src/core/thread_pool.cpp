@@ -0,0 +1,226 @@
+#include "core/thread_pool.h"
+#include "core/handler.h"
+#include "core/logger.h"
+#include <algorithm>
+
+LOG_TAG("ThreadPool");
+
+namespace {
+// 当前线程所属的线程池和工作线程序号
+thread_local ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+} // namespace
+
+ThreadPool& ThreadPool::getInstance() {
+    static ThreadPool instance(std::max(1u, std::thread::hardware_concurrency()));
+    return instance;
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // 队列全部建好后再启动线程，窃取时不会访问到未构造的Worker
+    for (size_t i = 0; i < threadCount; i++) {
+        workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+    }
+    LOGI("Thread pool started with %zu workers", threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool ThreadPool::isWorkerThread() const {
+    return currentPool == this;
+}
+
+void ThreadPool::submit(Task task) {
+    if (!task) {
+        return;
+    }
+    size_t index = isWorkerThread() ? currentWorker
+                                    : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    // 先计数再入队，取走任务时计数不会短暂为负
+    queuedTasks.fetch_add(1, std::memory_order_seq_cst);
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+
+    // 没有睡眠的线程时不碰sleepMutex
+    bool workersSleeping = sleepingWorkers.load(std::memory_order_seq_cst) > 0;
+    bool groupsWaiting = waitingGroups.load(std::memory_order_seq_cst) > 0;
+    if (workersSleeping || groupsWaiting) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (workersSleeping) {
+            workAvailable.notify_one();
+        }
+        if (groupsWaiting) {
+            groupProgress.notify_all();
+        }
+    }
+}
+
+void ThreadPool::submit(Task task, Handler* handler, InlineCallback continuation) {
+    submit([task = std::move(task), anchor = handler->getAnchor(),
+            continuation = std::move(continuation)]() mutable {
+        task();
+        // 空的continuation不投递，否则会作为what为0的消息交给handleMessage
+        if (continuation) {
+            anchor->post(std::move(continuation));
+        }
+    });
+}
+
+bool ThreadPool::takeTask(size_t index, Task& task) {
+    size_t count = workers.size();
+    if (index < count) {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // 从下一个开始依次窃取，避免所有线程都挤在第0个队列上
+    size_t start = index < count ? index + 1 : 0;
+    for (size_t i = 0; i < count; i++) {
+        Worker& victim = *workers[(start + i) % count];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    Task task;
+    if (!takeTask(isWorkerThread() ? currentWorker : workers.size(), task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::waitForTasks(const std::atomic<size_t>& pending) {
+    // 与工作线程相同，先登记再检查条件，submit和notifyGroupDone要么被这里看到，要么来唤醒
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    waitingGroups.fetch_add(1, std::memory_order_seq_cst);
+    groupProgress.wait(lock, [this, &pending]() {
+        return queuedTasks.load(std::memory_order_seq_cst) > 0 ||
+               pending.load(std::memory_order_acquire) == 0;
+    });
+    waitingGroups.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::notifyGroupDone() {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    if (waitingGroups.load(std::memory_order_relaxed) > 0) {
+        groupProgress.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        if (takeTask(index, task)) {
+            task();
+            continue;
+        }
+
+        // 先登记睡眠再检查计数，提交方要么被这里看到，要么看到登记后来唤醒
+        // 窃取用try_lock可能漏掉任务，queuedTasks不为0时不睡眠，重新扫描
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        workAvailable.wait(lock, [this]() {
+            return queuedTasks.load(std::memory_order_seq_cst) > 0 || stopping;
+        });
+        sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping && queuedTasks.load(std::memory_order_seq_cst) == 0) {
+            break;
+        }
+    }
+
+    currentPool = nullptr;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool(pool), state(std::make_shared<State>()) {
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(InlineCallback task) {
+    state->pending.fetch_add(1, std::memory_order_relaxed);
+    pool.submit([state = state, pool = &pool, task = std::move(task)]() mutable {
+        task();
+        finishTask(*state, *pool);
+    });
+}
+
+void TaskGroup::finishTask(State& state, ThreadPool& pool) {
+    if (state.pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    std::shared_ptr<HandlerAnchor> anchor;
+    InlineCallback continuation;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        anchor = std::move(state.anchor);
+        continuation = std::move(state.continuation);
+    }
+    pool.notifyGroupDone();
+    if (anchor && continuation) {
+        anchor->post(std::move(continuation));
+    }
+}
+
+void TaskGroup::wait() {
+    while (state->pending.load(std::memory_order_acquire) > 0) {
+        // 帮忙执行任务，在工作线程上等待也不会因为线程都被占住而死锁
+        if (pool.runPendingTask()) {
+            continue;
+        }
+        // 剩余任务都在别的线程上执行，睡到有新任务可帮忙或全部完成
+        pool.waitForTasks(state->pending);
+    }
+}
+
+void TaskGroup::notify(Handler* handler, InlineCallback continuation) {
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->pending.load(std::memory_order_acquire) > 0) {
+            state->anchor = handler->getAnchor();
+            state->continuation = std::move(continuation);
+            return;
+        }
+    }
+    if (continuation) {
+        handler->post(std::move(continuation));
+    }
+}
@@ -0,0 +1,173 @@
+#include "core/timing_wheel.h"
+#include "core/message.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace {
+constexpr int64_t kSlotMask = TimingWheel::kSlots - 1;
+// 最高层整圈的跨度，超出的消息放在最远处等待重新插入
+constexpr int64_t kMaxDelta = (int64_t(1) << (TimingWheel::kLevels * TimingWheel::kSlotBits)) - 1;
+
+// 从from开始循环查找第一个有消息的槽，返回距离（0-255），没有时返回-1
+int findOccupied(const uint64_t* bits, int from) {
+    constexpr int kWords = TimingWheel::kSlots / 64;
+    int offset = from & 63;
+    for (int n = 0; n <= kWords; n++) {
+        int word = ((from >> 6) + n) % kWords;
+        uint64_t value = bits[word];
+        if (n == 0) {
+            value &= ~uint64_t(0) << offset;
+        } else if (n == kWords) {
+            // 绕回到起始字，只看from之前的部分
+            value &= offset ? (uint64_t(1) << offset) - 1 : 0;
+        }
+        if (value) {
+            int slot = word * 64 + std::countr_zero(value);
+            return (slot - from + TimingWheel::kSlots) & kSlotMask;
+        }
+    }
+    return -1;
+}
+} // namespace
+
+void TimingWheel::reset(int64_t tick) {
+    currentTick = tick;
+}
+
+void TimingWheel::insert(Message* msg) {
+    place(msg, 1);
+}
+
+void TimingWheel::place(Message* msg, int64_t minDelta) {
+    int64_t expiry = tickFor(msg->when);
+    int64_t delta = std::min(std::max(expiry - currentTick, minDelta), kMaxDelta);
+    expiry = currentTick + delta;
+
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (int64_t(1) << ((level + 1) * kSlotBits))) {
+        level++;
+    }
+    link(msg, level, static_cast<int>((expiry >> (level * kSlotBits)) & kSlotMask));
+}
+
+void TimingWheel::link(Message* msg, int level, int slot) {
+    Message*& head = slots[level][slot];
+    msg->wheelPrev = nullptr;
+    msg->wheelNext = head;
+    if (head) {
+        head->wheelPrev = msg;
+    }
+    head = msg;
+    msg->wheelSlot = level * kSlots + slot;
+    occupied[level][slot >> 6] |= uint64_t(1) << (slot & 63);
+    count++;
+}
+
+void TimingWheel::remove(Message* msg) {
+    if (!contains(msg)) {
+        return;
+    }
+    int level = msg->wheelSlot / kSlots;
+    int slot = msg->wheelSlot % kSlots;
+    if (msg->wheelPrev) {
+        msg->wheelPrev->wheelNext = msg->wheelNext;
+    } else {
+        slots[level][slot] = msg->wheelNext;
+        if (!msg->wheelNext) {
+            occupied[level][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+        }
+    }
+    if (msg->wheelNext) {
+        msg->wheelNext->wheelPrev = msg->wheelPrev;
+    }
+    msg->wheelPrev = nullptr;
+    msg->wheelNext = nullptr;
+    msg->wheelSlot = -1;
+    count--;
+}
+
+bool TimingWheel::contains(const Message* msg) const {
+    return msg->wheelSlot >= 0;
+}
+
+void TimingWheel::cascade(int level, int slot) {
+    Message* msg = slots[level][slot];
+    slots[level][slot] = nullptr;
+    occupied[level][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+    while (msg) {
+        Message* next = msg->wheelNext;
+        count--;
+        // 降层发生在槽的起始刻度，恰好此刻到期的消息放进当前第0层槽，随后即被取出
+        place(msg, 0);
+        msg = next;
+    }
+}
+
+void TimingWheel::advance(int64_t tick, std::vector<Message*>& expired) {
+    while (currentTick < tick) {
+        int64_t next = count ? nextTick() : -1;
+        if (next < 0 || next > tick) {
+            currentTick = tick;
+            return;
+        }
+        currentTick = next;
+
+        // 先把走到的高层槽降到低层，从高到低处理
+        int top = 0;
+        while (top < kLevels - 1 && (currentTick & ((int64_t(1) << ((top + 1) * kSlotBits)) - 1)) == 0) {
+            top++;
+        }
+        for (int level = top; level >= 1; level--) {
+            cascade(level, static_cast<int>((currentTick >> (level * kSlotBits)) & kSlotMask));
+        }
+
+        int slot = static_cast<int>(currentTick & kSlotMask);
+        for (Message* msg = slots[0][slot]; msg;) {
+            Message* nextMsg = msg->wheelNext;
+            msg->wheelPrev = nullptr;
+            msg->wheelNext = nullptr;
+            msg->wheelSlot = -1;
+            count--;
+            expired.push_back(msg);
+            msg = nextMsg;
+        }
+        slots[0][slot] = nullptr;
+        occupied[0][slot >> 6] &= ~(uint64_t(1) << (slot & 63));
+    }
+}
+
+int64_t TimingWheel::nextTick() const {
+    if (count == 0) {
+        return -1;
+    }
+    int64_t best = std::numeric_limits<int64_t>::max();
+    for (int level = 0; level < kLevels; level++) {
+        int shift = level * kSlotBits;
+        int64_t position = currentTick >> shift;
+        int distance = findOccupied(occupied[level], static_cast<int>((position + 1) & kSlotMask));
+        if (distance >= 0) {
+            // 第0层是到期刻度，其余层是该槽降层的刻度
+            best = std::min(best, (position + 1 + distance) << shift);
+        }
+    }
+    return best;
+}
+
+void TimingWheel::takeAll(std::vector<Message*>& out) {
+    for (int level = 0; level < kLevels; level++) {
+        for (int slot = 0; slot < kSlots; slot++) {
+            for (Message* msg = slots[level][slot]; msg;) {
+                Message* next = msg->wheelNext;
+                msg->wheelPrev = nullptr;
+                msg->wheelNext = nullptr;
+                msg->wheelSlot = -1;
+                out.push_back(msg);
+                msg = next;
+            }
+            slots[level][slot] = nullptr;
+        }
+        std::fill(std::begin(occupied[level]), std::end(occupied[level]), 0);
+    }
+    count = 0;
+}
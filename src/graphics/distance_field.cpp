@@ -0,0 +1,157 @@
+#include "graphics/distance_field.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DISTANCE_FIELD_SSE2 1
+#endif
+
+namespace {
+// 距离场外部视为完全在轮廓之外
+inline float texel(const CachedGlyph& field, int x, int y) {
+    if (x < 0 || y < 0 || x >= field.width || y >= field.rows) {
+        return 0.0f;
+    }
+    return field.coverage[static_cast<size_t>(y) * field.width + x];
+}
+
+// 纹素中心位于(i + 0.5, j + 0.5)，调用方已减去0.5
+inline float sampleBilinear(const CachedGlyph& field, float u, float v) {
+    float fu = std::floor(u);
+    float fv = std::floor(v);
+    int x = static_cast<int>(fu);
+    int y = static_cast<int>(fv);
+    float wu = u - fu;
+    float wv = v - fv;
+    float top = texel(field, x, y) + (texel(field, x + 1, y) - texel(field, x, y)) * wu;
+    float bottom = texel(field, x, y + 1) +
+                   (texel(field, x + 1, y + 1) - texel(field, x, y + 1)) * wu;
+    return top + (bottom - top) * wv;
+}
+
+inline void writePixel(Bitmap* target, int x, int y, Color color, int alpha) {
+    // 与覆盖率遮罩的绘制方式保持一致
+    if (alpha > 0) {
+        Color pixelColor = color;
+        pixelColor.a = static_cast<uint8_t>(alpha);
+        target->setPixel(x, y, pixelColor);
+    }
+}
+} // namespace
+
+void drawDistanceField(Bitmap* target, const CachedGlyph& field,
+                       const Matrix& fieldToDevice, Color color) {
+    if (!target || field.coverage.empty()) {
+        return;
+    }
+
+    Matrix inverse;
+    if (!fieldToDevice.invert(inverse)) {
+        return;
+    }
+
+    // 距离场四个角在设备空间中的包围盒（Point为整数坐标，这里直接用矩阵计算）
+    const auto& m = fieldToDevice.m;
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    const float corners[4][2] = {
+        {0.0f, 0.0f}, {static_cast<float>(field.width), 0.0f},
+        {0.0f, static_cast<float>(field.rows)},
+        {static_cast<float>(field.width), static_cast<float>(field.rows)}};
+    for (const auto& corner : corners) {
+        float dx = m[0] * corner[0] + m[1] * corner[1] + m[2];
+        float dy = m[3] * corner[0] + m[4] * corner[1] + m[5];
+        minX = std::min(minX, dx);
+        minY = std::min(minY, dy);
+        maxX = std::max(maxX, dx);
+        maxY = std::max(maxY, dy);
+    }
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    int x1 = std::min(target->getWidth(), static_cast<int>(std::ceil(maxX)));
+    int y1 = std::min(target->getHeight(), static_cast<int>(std::ceil(maxY)));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    // 距离值128为轮廓，每单位对应spread/128个距离场像素，再换算为设备像素
+    float deviceScale = std::sqrt(std::fabs(m[0] * m[4] - m[1] * m[3]));
+    float k = kDistanceFieldSpread * deviceScale / 128.0f;
+    float maxAlpha = static_cast<float>(color.a);
+
+    const auto& im = inverse.m;
+    for (int py = y0; py < y1; py++) {
+        float cy = py + 0.5f;
+        // 行内u、v随x线性变化
+        float rowU = im[1] * cy + im[2] - 0.5f;
+        float rowV = im[4] * cy + im[5] - 0.5f;
+        int px = x0;
+
+#ifdef DISTANCE_FIELD_SSE2
+        const __m128 lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        const __m128 du = _mm_set1_ps(im[0]);
+        const __m128 dv = _mm_set1_ps(im[3]);
+        const __m128 baseU = _mm_set1_ps(rowU);
+        const __m128 baseV = _mm_set1_ps(rowV);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 edge = _mm_set1_ps(128.0f);
+        const __m128 scale = _mm_set1_ps(k);
+        const __m128 alphaScale = _mm_set1_ps(maxAlpha);
+
+        for (; px + 4 <= x1; px += 4) {
+            __m128 cx = _mm_add_ps(_mm_set1_ps(static_cast<float>(px)), lane);
+            __m128 u = _mm_add_ps(_mm_mul_ps(cx, du), baseU);
+            __m128 v = _mm_add_ps(_mm_mul_ps(cx, dv), baseV);
+
+            // SSE2没有floor，截断后对负数修正
+            __m128 fu = _mm_cvtepi32_ps(_mm_cvttps_epi32(u));
+            __m128 fv = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+            fu = _mm_sub_ps(fu, _mm_and_ps(_mm_cmpgt_ps(fu, u), one));
+            fv = _mm_sub_ps(fv, _mm_and_ps(_mm_cmpgt_ps(fv, v), one));
+            __m128 wu = _mm_sub_ps(u, fu);
+            __m128 wv = _mm_sub_ps(v, fv);
+
+            alignas(16) int32_t xs[4];
+            alignas(16) int32_t ys[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(xs), _mm_cvttps_epi32(fu));
+            _mm_store_si128(reinterpret_cast<__m128i*>(ys), _mm_cvttps_epi32(fv));
+
+            // 纹素读取是随机访问，逐个取出后再做向量插值
+            alignas(16) float t00[4], t10[4], t01[4], t11[4];
+            for (int i = 0; i < 4; i++) {
+                t00[i] = texel(field, xs[i], ys[i]);
+                t10[i] = texel(field, xs[i] + 1, ys[i]);
+                t01[i] = texel(field, xs[i], ys[i] + 1);
+                t11[i] = texel(field, xs[i] + 1, ys[i] + 1);
+            }
+            __m128 a = _mm_load_ps(t00);
+            __m128 b = _mm_load_ps(t10);
+            __m128 c = _mm_load_ps(t01);
+            __m128 d = _mm_load_ps(t11);
+            __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), wu));
+            __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), wu));
+            __m128 dist = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), wv));
+
+            __m128 coverage = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(dist, edge), scale), half);
+            coverage = _mm_min_ps(_mm_max_ps(coverage, zero), one);
+
+            alignas(16) int32_t alpha[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(alpha),
+                            _mm_cvtps_epi32(_mm_mul_ps(coverage, alphaScale)));
+            for (int i = 0; i < 4; i++) {
+                writePixel(target, px + i, py, color, alpha[i]);
+            }
+        }
+#endif
+
+        // 标量路径，也用于处理行尾不足4个的像素
+        for (; px < x1; px++) {
+            float cx = px + 0.5f;
+            float dist = sampleBilinear(field, im[0] * cx + rowU, im[3] * cx + rowV);
+            float coverage = std::clamp((dist - 128.0f) * k + 0.5f, 0.0f, 1.0f);
+            writePixel(target, px, py, color, static_cast<int>(std::lround(coverage * maxAlpha)));
+        }
+    }
+}
@@ -0,0 +1,295 @@
+#include "graphics/editable_layout.h"
+#include "graphics/line_breaker.h"
+#include "graphics/utf8.h"
+#include <algorithm>
+
+namespace {
+bool isTrailingSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+} // namespace
+
+EditableLayout::EditableLayout(IFontRenderer& renderer, const TextStyle& style, int maxWidth)
+    : renderer(renderer), style(style), maxWidth(maxWidth) {
+    auto metrics = renderer.getFontMetrics(style);
+    lineHeight = metrics.getLineHeight();
+    baselineOffset = metrics.getBaselineOffset();
+}
+
+void EditableLayout::reset(const GapBuffer& text) {
+    paragraphs.clear();
+    lineCount = 0;
+
+    size_t start = 0;
+    while (true) {
+        size_t end = text.find('\n', start);
+        paragraphs.push_back(buildParagraph(text, start, end - start));
+        lineCount += paragraphs.back().lines.size();
+        if (end >= text.size()) {
+            break;
+        }
+        start = end + 1;
+    }
+    updateFollowing(0, 0, 0);
+}
+
+void EditableLayout::setMaxWidth(const GapBuffer& text, int maxWidth) {
+    if (this->maxWidth == maxWidth) {
+        return;
+    }
+    this->maxWidth = maxWidth;
+    lineCount = 0;
+    for (auto& paragraph : paragraphs) {
+        paragraph.lines.clear();
+        rebreak(text, paragraph, 0, paragraph.length, 0);
+        lineCount += paragraph.lines.size();
+    }
+    updateFollowing(0, 0, 0);
+}
+
+void EditableLayout::onInsert(const GapBuffer& text, size_t pos, size_t length) {
+    replace(text, pos, 0, length);
+}
+
+void EditableLayout::onErase(const GapBuffer& text, size_t pos, size_t length) {
+    replace(text, pos, length, 0);
+}
+
+size_t EditableLayout::findParagraph(size_t pos) const {
+    auto it = std::upper_bound(paragraphs.begin(), paragraphs.end(), pos,
+        [](size_t value, const Paragraph& paragraph) { return value < paragraph.start; });
+    return it == paragraphs.begin() ? 0 : (it - paragraphs.begin()) - 1;
+}
+
+size_t EditableLayout::findParagraphForLine(size_t line) const {
+    auto it = std::upper_bound(paragraphs.begin(), paragraphs.end(), line,
+        [](size_t value, const Paragraph& paragraph) { return value < paragraph.firstLine; });
+    return it == paragraphs.begin() ? 0 : (it - paragraphs.begin()) - 1;
+}
+
+void EditableLayout::getCaretPosition(size_t pos, size_t& line, float& x) const {
+    const Paragraph& paragraph = paragraphs[findParagraph(pos)];
+    size_t offset = std::min(pos - paragraph.start, paragraph.length);
+
+    // 行尾与下一行行首重合时光标显示在下一行开头
+    size_t index = 0;
+    while (index + 1 < paragraph.lines.size() && paragraph.lines[index + 1].start <= offset) {
+        index++;
+    }
+    const Line& current = paragraph.lines[index];
+
+    x = 0;
+    for (size_t i = current.start; i < offset; i++) {
+        x += paragraph.advances[i];
+    }
+    line = paragraph.firstLine + index;
+}
+
+void EditableLayout::replace(const GapBuffer& text, size_t pos, size_t oldLength,
+                             size_t newLength) {
+    ptrdiff_t delta = static_cast<ptrdiff_t>(newLength) - static_cast<ptrdiff_t>(oldLength);
+    size_t first = findParagraph(pos);
+    size_t last = findParagraph(pos + oldLength);
+
+    bool newlineInserted = false;
+    for (size_t i = pos; i < pos + newLength; i++) {
+        if (text.at(i) == '\n') {
+            newlineInserted = true;
+            break;
+        }
+    }
+
+    if (first != last || newlineInserted) {
+        // 段落结构发生变化，只对涉及的段落整体重新排版
+        size_t regionStart = paragraphs[first].start;
+        size_t regionEnd = paragraphs[last].start + paragraphs[last].length + delta;
+        for (size_t i = first; i <= last; i++) {
+            lineCount -= paragraphs[i].lines.size();
+        }
+
+        std::vector<Paragraph> rebuilt;
+        size_t start = regionStart;
+        while (true) {
+            size_t end = std::min(text.find('\n', start), regionEnd);
+            rebuilt.push_back(buildParagraph(text, start, end - start));
+            lineCount += rebuilt.back().lines.size();
+            if (end >= regionEnd) {
+                break;
+            }
+            start = end + 1;
+        }
+
+        paragraphs.erase(paragraphs.begin() + first, paragraphs.begin() + last + 1);
+        paragraphs.insert(paragraphs.begin() + first,
+                          std::make_move_iterator(rebuilt.begin()),
+                          std::make_move_iterator(rebuilt.end()));
+        updateFollowing(first, first + rebuilt.size() - 1, delta);
+        return;
+    }
+
+    Paragraph& paragraph = paragraphs[first];
+    size_t offset = pos - paragraph.start;
+
+    // 找出与编辑范围相交的片段，两侧各多取一个，让片段边界上的整形和换行机会也得到更新
+    auto runAfter = [&paragraph](size_t value) {
+        return std::upper_bound(paragraph.runs.begin(), paragraph.runs.end(), value,
+            [](size_t v, const Run& run) { return v < run.start; }) - paragraph.runs.begin();
+    };
+    size_t firstRun = runAfter(offset);
+    firstRun = firstRun > 1 ? firstRun - 2 : 0;
+    size_t lastRun = std::min<size_t>(runAfter(offset + oldLength) + 1, paragraph.runs.size());
+
+    size_t regionStart = firstRun < paragraph.runs.size() ? paragraph.runs[firstRun].start : 0;
+    size_t regionEnd = lastRun > 0 ? paragraph.runs[lastRun - 1].start +
+                                     paragraph.runs[lastRun - 1].length : 0;
+    regionEnd = std::max(regionEnd, offset + oldLength) + delta;
+
+    // 同步每字节的宽度和换行机会
+    paragraph.advances.erase(paragraph.advances.begin() + offset,
+                             paragraph.advances.begin() + offset + oldLength);
+    paragraph.advances.insert(paragraph.advances.begin() + offset, newLength, 0.0f);
+    paragraph.breaks.erase(paragraph.breaks.begin() + offset,
+                           paragraph.breaks.begin() + offset + oldLength);
+    paragraph.breaks.insert(paragraph.breaks.begin() + offset, newLength, LineBreaker::None);
+    paragraph.length += delta;
+
+    paragraph.runs.erase(paragraph.runs.begin() + firstRun, paragraph.runs.begin() + lastRun);
+    for (size_t i = firstRun; i < paragraph.runs.size(); i++) {
+        paragraph.runs[i].start += delta;
+    }
+    reshape(text, paragraph, firstRun, regionStart, regionEnd);
+
+    lineCount -= paragraph.lines.size();
+    rebreak(text, paragraph, offset, regionEnd, delta);
+    lineCount += paragraph.lines.size();
+    updateFollowing(first, first, delta);
+}
+
+EditableLayout::Paragraph EditableLayout::buildParagraph(const GapBuffer& text,
+                                                         size_t start, size_t length) {
+    Paragraph paragraph;
+    paragraph.start = start;
+    paragraph.length = length;
+    paragraph.advances.assign(length, 0.0f);
+    paragraph.breaks.assign(length, LineBreaker::None);
+    reshape(text, paragraph, 0, 0, length);
+    rebreak(text, paragraph, 0, length, 0);
+    return paragraph;
+}
+
+void EditableLayout::reshape(const GapBuffer& text, Paragraph& paragraph, size_t runIndex,
+                             size_t from, size_t to) {
+    if (from >= to) {
+        return;
+    }
+
+    // 区域首字节的换行机会取决于区域外的前一个字符，保留原值
+    std::string region = text.substr(paragraph.start + from, to - from);
+    auto breaks = LineBreaker::analyze(region);
+    uint8_t boundary = from > 0 ? paragraph.breaks[from] : LineBreaker::None;
+    std::copy(breaks.begin(), breaks.end(), paragraph.breaks.begin() + from);
+    paragraph.breaks[from] = boundary;
+
+    std::vector<Run> runs;
+    size_t runStart = from;
+    for (size_t i = from + 1; i <= to; i++) {
+        size_t length = i - runStart;
+        bool split = i == to ||
+            (length >= kMinRunBytes && paragraph.breaks[i] != LineBreaker::None) ||
+            (length >= kMaxRunBytes && !isUtf8Continuation(region[i - from]));
+        if (!split) {
+            continue;
+        }
+
+        auto advances = renderer.getTextAdvances(region.substr(runStart - from, length), style);
+        std::copy(advances.begin(), advances.begin() + std::min(advances.size(), length),
+                  paragraph.advances.begin() + runStart);
+        runs.push_back({runStart, length});
+        runStart = i;
+    }
+    paragraph.runs.insert(paragraph.runs.begin() + runIndex, runs.begin(), runs.end());
+}
+
+void EditableLayout::rebreak(const GapBuffer& text, Paragraph& paragraph, size_t from,
+                             size_t stableFrom, ptrdiff_t delta) {
+    std::vector<Line> oldLines = std::move(paragraph.lines);
+    paragraph.lines.clear();
+
+    // 从编辑所在行的前一行开始，删除可能让后面的单词挪回上一行
+    size_t keep = 0;
+    while (keep + 1 < oldLines.size() && oldLines[keep + 1].start <= from) {
+        keep++;
+    }
+    keep = keep > 0 ? keep - 1 : 0;
+    paragraph.lines.assign(oldLines.begin(), oldLines.begin() + keep);
+
+    size_t start = keep < oldLines.size() ? oldLines[keep].start : 0;
+    do {
+        Line line;
+        line.start = start;
+        line.end = breakLine(text, paragraph, start, line.width);
+        paragraph.lines.push_back(line);
+        start = line.end;
+
+        if (start >= stableFrom && start < paragraph.length) {
+            // 新行首与编辑后的某个旧行首重合，之后的折行结果不变
+            size_t oldStart = start - delta;
+            auto it = std::lower_bound(oldLines.begin() + keep, oldLines.end(), oldStart,
+                [](const Line& l, size_t value) { return l.start < value; });
+            if (it != oldLines.end() && it->start == oldStart) {
+                for (; it != oldLines.end(); ++it) {
+                    Line shifted = *it;
+                    shifted.start += delta;
+                    shifted.end += delta;
+                    paragraph.lines.push_back(shifted);
+                }
+                return;
+            }
+        }
+    } while (start < paragraph.length);
+}
+
+size_t EditableLayout::breakLine(const GapBuffer& text, const Paragraph& paragraph,
+                                 size_t start, float& width) const {
+    size_t end = paragraph.length;
+    float lineWidth = 0;
+    size_t lastBreak = start;
+    for (size_t pos = start; pos < paragraph.length; pos++) {
+        if (pos > start && paragraph.breaks[pos] == LineBreaker::Mandatory) {
+            end = pos;
+            break;
+        }
+        if (pos > start && paragraph.breaks[pos] == LineBreaker::Allowed) {
+            lastBreak = pos;
+        }
+
+        // 行尾空白不参与溢出判断；单词比整行还宽时按簇强制断开
+        float advance = paragraph.advances[pos];
+        if (maxWidth > 0 && advance > 0 && pos > start && lineWidth + advance > maxWidth &&
+            !isTrailingSpace(text.at(paragraph.start + pos))) {
+            end = lastBreak > start ? lastBreak : pos;
+            break;
+        }
+        lineWidth += advance;
+    }
+
+    size_t trimmed = end;
+    while (trimmed > start && isTrailingSpace(text.at(paragraph.start + trimmed - 1))) {
+        trimmed--;
+    }
+    width = 0;
+    for (size_t i = start; i < trimmed; i++) {
+        width += paragraph.advances[i];
+    }
+    return end;
+}
+
+void EditableLayout::updateFollowing(size_t first, size_t last, ptrdiff_t delta) {
+    for (size_t i = last + 1; i < paragraphs.size(); i++) {
+        paragraphs[i].start += delta;
+    }
+    for (size_t i = first; i < paragraphs.size(); i++) {
+        paragraphs[i].firstLine = i > 0 ?
+            paragraphs[i - 1].firstLine + paragraphs[i - 1].lines.size() : 0;
+    }
+}
@@ -0,0 +1,55 @@
+#include "graphics/font_coverage.h"
+#include <algorithm>
+
+FontCoverage::FontCoverage()
+    : pageIndex(kMaxCodepoint >> kPageShift, kEmptyPage) {
+    Page empty{};
+    Page full;
+    full.fill(~0ull);
+    pages.push_back(empty);
+    pages.push_back(full);
+}
+
+void FontCoverage::build(FT_Face face) {
+    std::fill(pageIndex.begin(), pageIndex.end(), kEmptyPage);
+    pages.resize(2);
+
+    if (!face || FT_Select_Charmap(face, FT_ENCODING_UNICODE) != 0) {
+        return;
+    }
+
+    FT_UInt glyphIndex = 0;
+    FT_ULong codepoint = FT_Get_First_Char(face, &glyphIndex);
+    while (glyphIndex != 0) {
+        if (codepoint < kMaxCodepoint) {
+            uint32_t pageNo = codepoint >> kPageShift;
+            if (pageIndex[pageNo] == kEmptyPage) {
+                pageIndex[pageNo] = static_cast<uint16_t>(pages.size());
+                pages.emplace_back();
+            }
+            uint32_t bit = codepoint & (kPageSize - 1);
+            pages[pageIndex[pageNo]][bit >> 6] |= 1ull << (bit & 63);
+        }
+        codepoint = FT_Get_Next_Char(face, codepoint, &glyphIndex);
+    }
+
+    // 将满页折叠到共享的满页上
+    std::vector<Page> compact(pages.begin(), pages.begin() + 2);
+    for (auto& index : pageIndex) {
+        if (index <= kFullPage) {
+            continue;
+        }
+        const Page& page = pages[index];
+        bool full = true;
+        for (uint64_t word : page) {
+            full &= (word == ~0ull);
+        }
+        if (full) {
+            index = kFullPage;
+        } else {
+            compact.push_back(page);
+            index = static_cast<uint16_t>(compact.size() - 1);
+        }
+    }
+    pages = std::move(compact);
+}
@@ -0,0 +1,221 @@
+#include "graphics/font_registry.h"
+#include "core/logger.h"
+#include "core/looper.h"
+#include <algorithm>
+#include <filesystem>
+
+LOG_TAG("FontRegistry");
+
+void FontFace::setPixelSize(int size) {
+    if (size == currentSize) {
+        return;
+    }
+    FT_Set_Pixel_Sizes(ftFace, 0, size);
+    hb_ft_font_changed(hbFont);
+    currentSize = size;
+}
+
+FontFace* FontEntry::getFace() {
+    std::call_once(openFlag, [this]() { owner->openFace(*this); });
+    return face.get();
+}
+
+FontRegistry& FontRegistry::getInstance() {
+    static FontRegistry instance;
+    return instance;
+}
+
+FontRegistry::FontRegistry() {
+    ftWrapper.initialize();
+}
+
+FontRegistry::~FontRegistry() {
+    if (writeBackThread.joinable()) {
+        writeBackThread.join();
+    }
+    glyphCache.clear();
+    for (auto& [path, entry] : entries) {
+        if (entry->face) {
+            hbWrapper.destroyFont(entry->face->hbFont);
+            ftWrapper.destroyFace(entry->face->ftFace);
+            entry->face.reset();
+        }
+        entry->file.close();
+    }
+    ftWrapper.cleanup();
+}
+
+bool FontRegistry::registerFont(const std::string& name, const std::string& path) {
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(path, ec)) {
+        LOGE("Font file not found: %s", path.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& entry = entries[path];
+    if (!entry) {
+        entry.reset(new FontEntry(this, path));
+    }
+    names[name] = entry.get();
+    generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void FontRegistry::setFallbackFonts(const std::string& name,
+                                    const std::vector<std::string>& fallbacks) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fallbackNames[name] = fallbacks;
+    generation.fetch_add(1, std::memory_order_release);
+}
+
+std::vector<FontEntry*> FontRegistry::getFontChain(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<FontEntry*> chain;
+    auto addFont = [&](const std::string& fontName) {
+        auto it = names.find(fontName);
+        if (it != names.end() &&
+            std::find(chain.begin(), chain.end(), it->second) == chain.end()) {
+            chain.push_back(it->second);
+        }
+    };
+
+    addFont(name);
+    auto fallbacks = fallbackNames.find(name);
+    if (fallbacks != fallbackNames.end()) {
+        for (const auto& fallback : fallbacks->second) {
+            addFont(fallback);
+        }
+    }
+    return chain;
+}
+
+void FontRegistry::openFace(FontEntry& entry) {
+    if (!entry.file.open(entry.path)) {
+        LOGE("Failed to map font file: %s", entry.path.c_str());
+        return;
+    }
+
+    auto face = std::make_unique<FontFace>();
+    {
+        std::lock_guard<std::mutex> lock(libraryMutex);
+        if (ftWrapper.loadMemoryFace(entry.file.data(), entry.file.size(),
+                                     &face->ftFace) != 0) {
+            LOGE("Failed to create font face: %s", entry.path.c_str());
+            entry.file.close();
+            return;
+        }
+    }
+
+    face->hbFont = hbWrapper.createFont(face->ftFace);
+    if (!face->hbFont) {
+        std::lock_guard<std::mutex> lock(libraryMutex);
+        ftWrapper.destroyFace(face->ftFace);
+        entry.file.close();
+        return;
+    }
+
+    face->coverage.build(face->ftFace);
+    face->simpleShaping = SimpleShaper::supportsFace(face->ftFace);
+    face->fileHash = TextDiskCache::hashFontFile(entry.file.data(), entry.file.size());
+    face->fileData = entry.file.data();
+    face->fileSize = entry.file.size();
+    entry.face = std::move(face);
+    LOGI("Font opened on first use: %s", entry.path.c_str());
+}
+
+FT_Face FontRegistry::createFaceClone(const FontFace& font) {
+    FT_Face clone = nullptr;
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    if (ftWrapper.loadMemoryFace(font.fileData, font.fileSize, &clone) != 0) {
+        return nullptr;
+    }
+    return clone;
+}
+
+void FontRegistry::destroyFaceClone(FT_Face face) {
+    std::lock_guard<std::mutex> lock(libraryMutex);
+    ftWrapper.destroyFace(face);
+}
+
+void FontRegistry::enablePersistentCache(const std::string& path) {
+    diskCachePath = path;
+    diskCache.open(path);
+}
+
+void FontRegistry::notifyCacheMiss() {
+    if (diskCachePath.empty() || writeBackScheduled.exchange(true)) {
+        return;
+    }
+    // 写回由当前线程的Looper调度，文件写入放到后台线程
+    Looper* looper = Looper::getCurrentThreadLooper();
+    if (!looper) {
+        writeBackScheduled = false;
+        return;
+    }
+    scheduleWriteBack(looper->getQueue());
+}
+
+void FontRegistry::scheduleWriteBack(MessageQueue* queue) {
+    // 启动阶段会连续产生新字形，两次写回之间至少间隔kWriteBackInterval
+    auto elapsed = std::chrono::steady_clock::now() - lastWriteBack;
+    int64_t delayMillis = elapsed < kWriteBackInterval
+        ? std::chrono::duration_cast<std::chrono::milliseconds>(kWriteBackInterval - elapsed).count()
+        : 0;
+    queue->postDelayed([this, queue]() {
+        // 到时后等到空闲再写回，只执行一次
+        queue->addIdleHandler([this, queue]() {
+            if (!writeBackPersistentCache()) {
+                scheduleWriteBack(queue);
+            }
+            return false;
+        });
+    }, delayMillis);
+}
+
+bool FontRegistry::writeBackPersistentCache() {
+    // 上一次写回还没结束时不在Looper线程上等待
+    if (writeBackRunning.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (writeBackThread.joinable()) {
+        writeBackThread.join();  // 已经结束，不会阻塞
+    }
+    // 快照之后新产生的字形由下一次写回处理
+    writeBackScheduled = false;
+
+    // 内存缓存中的内容即为最近常用的字形和字符串，整体写出
+    std::unordered_map<const void*, uint64_t> faceHashes;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [path, entry] : entries) {
+            if (entry->face) {
+                faceHashes[entry->face->ftFace] = entry->face->fileHash;
+            }
+        }
+    }
+
+    std::vector<TextDiskCache::GlyphRecord> glyphs;
+    for (auto& [key, glyph] : glyphCache.snapshot()) {
+        auto it = faceHashes.find(key.face);
+        if (it != faceHashes.end()) {
+            glyphs.push_back({it->second, key, std::move(glyph)});
+        }
+    }
+    std::vector<TextDiskCache::ShapeRecord> shapes;
+    for (auto& [key, result] : shapeCache.snapshot()) {
+        auto it = faceHashes.find(key.face);
+        if (it != faceHashes.end()) {
+            shapes.push_back({it->second, key, std::move(result)});
+        }
+    }
+
+    lastWriteBack = std::chrono::steady_clock::now();
+    writeBackRunning.store(true, std::memory_order_relaxed);
+    writeBackThread = std::thread([this, glyphs = std::move(glyphs), shapes = std::move(shapes)]() {
+        diskCache.write(glyphs, shapes);
+        writeBackRunning.store(false, std::memory_order_release);
+    });
+    return true;
+}
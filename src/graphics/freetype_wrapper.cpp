@@ -1,4 +1,102 @@
 #include "graphics/freetype_wrapper.h"
+#include FT_OUTLINE_H
+#include FT_TRUETYPE_TABLES_H
+#include FT_LCD_FILTER_H
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LCD_BLEND_SSE2 1
+#endif
+
+namespace {
+void blitCoverage(Bitmap* target, const uint8_t* src, int width, int rows,
+                  int pitch, int x, int y, Color color) {
+    for (int row = 0; row < rows; row++) {
+        int py = y + row;
+        if (py < 0 || py >= target->getHeight()) {
+            src += pitch;
+            continue;
+        }
+        for (int col = 0; col < width; col++) {
+            int px = x + col;
+            if (px < 0 || px >= target->getWidth()) {
+                continue;
+            }
+            
+            uint8_t alpha = src[col];
+            if (alpha > 0) {
+                Color pixelColor = color;
+                pixelColor.a = (color.a * alpha) / 255;
+                target->setPixel(px, py, pixelColor);
+            }
+        }
+        src += pitch;
+    }
+}
+
+// 覆盖率乘以颜色alpha后换算到0-256，便于用移位代替除以255
+inline uint16_t blendWeight(uint8_t coverage, uint8_t alpha) {
+    uint32_t w = (coverage * alpha + 127) / 255;
+    return static_cast<uint16_t>(w + (w >> 7));
+}
+
+// 把一行LCD遮罩混合到BGRA8888像素上，dst和mask已按裁剪范围对齐
+// 每个颜色通道使用各自子像素的覆盖率，alpha通道使用三者中的最大值
+void blendLcdRow(uint8_t* dst, const uint8_t* mask, int count, Color color, bool bgr) {
+    auto weights = [&](int i, uint16_t* w) {
+        const uint8_t* m = mask + i * 3;
+        uint8_t covR = bgr ? m[2] : m[0];
+        uint8_t covB = bgr ? m[0] : m[2];
+        w[0] = blendWeight(covB, color.a);
+        w[1] = blendWeight(m[1], color.a);
+        w[2] = blendWeight(covR, color.a);
+        w[3] = std::max({w[0], w[1], w[2]});
+    };
+    
+    int i = 0;
+#ifdef LCD_BLEND_SSE2
+    // 一次处理4个像素：权重逐像素准备，混合在16位通道中并行完成
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(256);
+    const __m128i src = _mm_setr_epi16(color.b, color.g, color.r, 255,
+                                       color.b, color.g, color.r, 255);
+    for (; i + 4 <= count; i += 4) {
+        alignas(16) uint16_t w[16];
+        for (int p = 0; p < 4; p++) {
+            weights(i + p, w + p * 4);
+        }
+        __m128i wLo = _mm_load_si128(reinterpret_cast<const __m128i*>(w));
+        __m128i wHi = _mm_load_si128(reinterpret_cast<const __m128i*>(w + 8));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_or_si128(wLo, wHi), zero)) == 0xFFFF) {
+            continue;
+        }
+        
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i * 4));
+        __m128i dLo = _mm_unpacklo_epi8(pixels, zero);
+        __m128i dHi = _mm_unpackhi_epi8(pixels, zero);
+        // d * (256 - w) + s * w 不超过255 * 256，16位无符号运算不会溢出
+        __m128i rLo = _mm_add_epi16(_mm_mullo_epi16(dLo, _mm_sub_epi16(full, wLo)),
+                                    _mm_mullo_epi16(src, wLo));
+        __m128i rHi = _mm_add_epi16(_mm_mullo_epi16(dHi, _mm_sub_epi16(full, wHi)),
+                                    _mm_mullo_epi16(src, wHi));
+        rLo = _mm_srli_epi16(rLo, 8);
+        rHi = _mm_srli_epi16(rHi, 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_packus_epi16(rLo, rHi));
+    }
+#endif
+    
+    const uint8_t source[4] = {color.b, color.g, color.r, 255};
+    for (; i < count; i++) {
+        uint16_t w[4];
+        weights(i, w);
+        uint8_t* pixel = dst + i * 4;
+        for (int c = 0; c < 4; c++) {
+            pixel[c] = static_cast<uint8_t>((pixel[c] * (256 - w[c]) + source[c] * w[c]) >> 8);
+        }
+    }
+}
+} // namespace
 
 FreeTypeWrapper::FreeTypeWrapper() : library(nullptr) {}
 
@@ -7,7 +105,12 @@ FreeTypeWrapper::~FreeTypeWrapper() {
 }
 
 bool FreeTypeWrapper::initialize() {
-    return FT_Init_FreeType(&library) == 0;
+    if (FT_Init_FreeType(&library) != 0) {
+        return false;
+    }
+    // 未启用ClearType滤波的FreeType构建使用Harmony算法，设置失败不影响LCD渲染
+    FT_Library_SetLcdFilter(library, FT_LCD_FILTER_DEFAULT);
+    return true;
 }
 
 void FreeTypeWrapper::cleanup() {
@@ -21,24 +124,60 @@ FT_Error FreeTypeWrapper::loadFace(const std::string& fontPath, FT_Face* face) {
     return FT_New_Face(library, fontPath.c_str(), 0, face);
 }
 
+FT_Error FreeTypeWrapper::loadMemoryFace(const uint8_t* data, size_t size, FT_Face* face) {
+    return FT_New_Memory_Face(library, data, static_cast<FT_Long>(size), 0, face);
+}
+
 void FreeTypeWrapper::destroyFace(FT_Face face) {
     if (face) {
         FT_Done_Face(face);
     }
 }
 
-bool FreeTypeWrapper::renderGlyph(FT_Face face, uint32_t glyphIndex, int size) {
+bool FreeTypeWrapper::renderGlyph(FT_Face face, uint32_t glyphIndex, FT_Pos xShift) {
     if (!face) return false;
     
-    FT_Set_Pixel_Sizes(face, 0, size);
-    
     if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT) != 0) {
         return false;
     }
     
+    // 在光栅化之前平移轮廓，得到子像素相位对应的遮罩
+    if (xShift != 0 && face->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+        FT_Outline_Translate(&face->glyph->outline, xShift, 0);
+    }
+    
     return FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL) == 0;
 }
 
+bool FreeTypeWrapper::renderGlyphLcd(FT_Face face, uint32_t glyphIndex, FT_Pos xShift) {
+    if (!face) return false;
+    
+    if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_TARGET_LCD) != 0) {
+        return false;
+    }
+    
+    if (xShift != 0 && face->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+        FT_Outline_Translate(&face->glyph->outline, xShift, 0);
+    }
+    
+    return FT_Render_Glyph(face->glyph, FT_RENDER_MODE_LCD) == 0;
+}
+
+bool FreeTypeWrapper::renderGlyphDistanceField(FT_Face face, uint32_t glyphIndex) {
+    if (!face) return false;
+    
+#if FREETYPE_MAJOR > 2 || (FREETYPE_MAJOR == 2 && FREETYPE_MINOR >= 11)
+    // 距离场会被任意缩放，不做hinting
+    if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_NO_HINTING) != 0) {
+        return false;
+    }
+    return FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF) == 0;
+#else
+    (void)glyphIndex;
+    return false;
+#endif
+}
+
 void FreeTypeWrapper::drawGlyphBitmap(
     Bitmap* target,
     const FT_Bitmap& bitmap,
@@ -47,38 +186,82 @@ void FreeTypeWrapper::drawGlyphBitmap(
     
     if (!target) return;
     
-    const uint8_t* src = bitmap.buffer;
-    for (unsigned int row = 0; row < bitmap.rows; row++) {
-        for (unsigned int col = 0; col < bitmap.width; col++) {
-            int px = x + col;
-            int py = y + row;
-            
-            if (px < 0 || py < 0 || 
-                px >= target->getWidth() || 
-                py >= target->getHeight()) {
-                continue;
-            }
-            
-            uint8_t alpha = src[col];
-            if (alpha > 0) {
-                Color pixelColor = color;
-                pixelColor.a = (color.a * alpha) / 255;
-                target->setPixel(px, py, pixelColor);
-            }
+    blitCoverage(target, bitmap.buffer, bitmap.width, bitmap.rows,
+                 bitmap.pitch, x, y, color);
+}
+
+void FreeTypeWrapper::drawGlyphMask(
+    Bitmap* target,
+    const CachedGlyph& glyph,
+    int x, int y,
+    Color color) {
+    
+    if (!target || glyph.coverage.empty()) return;
+    
+    blitCoverage(target, glyph.coverage.data(), glyph.width, glyph.rows,
+                 glyph.width, x, y, color);
+}
+
+void FreeTypeWrapper::drawGlyphLcdMask(
+    Bitmap* target,
+    const CachedGlyph& glyph,
+    int x, int y,
+    Color color,
+    SubpixelOrder order) {
+    
+    if (!target || glyph.coverage.empty() ||
+        target->getFormat().baseFormat != BasePixelFormat::BGRA8888) return;
+    
+    int left = std::max(0, -x);
+    int right = std::min(glyph.width, target->getWidth() - x);
+    if (left >= right) return;
+    
+    int rowBytes = glyph.width * 3;
+    for (int row = 0; row < glyph.rows; row++) {
+        int py = y + row;
+        if (py < 0 || py >= target->getHeight()) {
+            continue;
         }
-        src += bitmap.pitch;
+        uint8_t* dst = target->getPixels() + py * target->getStride() + (x + left) * 4;
+        const uint8_t* mask = glyph.coverage.data() + row * rowBytes + left * 3;
+        blendLcdRow(dst, mask, right - left, color, order == SubpixelOrder::BGR);
+    }
+}
+
+IFontRenderer::FontMetrics FreeTypeWrapper::getFontMetrics(FT_Face face) {
+    IFontRenderer::FontMetrics metrics{};
+    if (!face || !face->size) return metrics;
+    
+    const FT_Size_Metrics& size = face->size->metrics;
+    metrics.ascent = size.ascender / 64.0f;
+    metrics.descent = -size.descender / 64.0f;
+    metrics.lineGap = std::max(0.0f, size.height / 64.0f - metrics.ascent - metrics.descent);
+    
+    auto* os2 = static_cast<TT_OS2*>(FT_Get_Sfnt_Table(face, FT_SFNT_OS2));
+    if (os2 && os2->version >= 2 && os2->sxHeight > 0 && os2->sCapHeight > 0) {
+        metrics.xHeight = FT_MulFix(os2->sxHeight, size.y_scale) / 64.0f;
+        metrics.capHeight = FT_MulFix(os2->sCapHeight, size.y_scale) / 64.0f;
+    } else {
+        auto measure = [face](FT_ULong ch) {
+            FT_UInt index = FT_Get_Char_Index(face, ch);
+            if (index == 0 || FT_Load_Glyph(face, index, FT_LOAD_DEFAULT) != 0) {
+                return 0.0f;
+            }
+            return face->glyph->metrics.horiBearingY / 64.0f;
+        };
+        metrics.xHeight = measure('x');
+        metrics.capHeight = measure('H');
     }
+    return metrics;
 }
 
 IFontRenderer::GlyphMetrics FreeTypeWrapper::getGlyphMetrics(
     FT_Face face,
-    uint32_t glyphIndex,
-    int size) {
+    uint32_t glyphIndex) {
     
     IFontRenderer::GlyphMetrics metrics{};
     if (!face) return metrics;
     
-    FT_Set_Pixel_Sizes(face, 0, size);
     if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT) != 0) {
         return metrics;
     }
@@ -0,0 +1,99 @@
+#include "graphics/gap_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+GapBuffer::GapBuffer(const std::string& text) {
+    insert(0, text);
+}
+
+void GapBuffer::moveGap(size_t pos) {
+    if (pos < gapStart) {
+        // 间隙左移，把[pos, gapStart)搬到间隙之后
+        size_t count = gapStart - pos;
+        std::memmove(buffer.data() + gapEnd - count, buffer.data() + pos, count);
+        gapStart -= count;
+        gapEnd -= count;
+    } else if (pos > gapStart) {
+        size_t count = pos - gapStart;
+        std::memmove(buffer.data() + gapStart, buffer.data() + gapEnd, count);
+        gapStart += count;
+        gapEnd += count;
+    }
+}
+
+void GapBuffer::reserveGap(size_t length) {
+    if (gapLength() >= length) {
+        return;
+    }
+
+    // 按当前大小成倍扩容，保证连续插入均摊O(1)
+    size_t textSize = size();
+    size_t newGap = std::max({length, kMinGap, textSize / 2});
+    std::vector<char> grown(textSize + newGap);
+    std::copy(buffer.begin(), buffer.begin() + gapStart, grown.begin());
+    std::copy(buffer.begin() + gapEnd, buffer.end(), grown.begin() + gapStart + newGap);
+    buffer.swap(grown);
+    gapEnd = gapStart + newGap;
+}
+
+void GapBuffer::insert(size_t pos, const char* data, size_t length) {
+    pos = std::min(pos, size());
+    if (length == 0) {
+        return;
+    }
+    moveGap(pos);
+    reserveGap(length);
+    std::memcpy(buffer.data() + gapStart, data, length);
+    gapStart += length;
+}
+
+void GapBuffer::erase(size_t pos, size_t length) {
+    pos = std::min(pos, size());
+    length = std::min(length, size() - pos);
+    if (length == 0) {
+        return;
+    }
+    moveGap(pos);
+    gapEnd += length;
+}
+
+void GapBuffer::clear() {
+    buffer.clear();
+    gapStart = 0;
+    gapEnd = 0;
+}
+
+std::string GapBuffer::substr(size_t pos, size_t length) const {
+    pos = std::min(pos, size());
+    length = std::min(length, size() - pos);
+
+    std::string result;
+    result.reserve(length);
+    size_t end = pos + length;
+    if (pos < gapStart) {
+        result.append(buffer.data() + pos, std::min(end, gapStart) - pos);
+    }
+    if (end > gapStart) {
+        size_t from = std::max(pos, gapStart);
+        result.append(buffer.data() + from + gapLength(), end - from);
+    }
+    return result;
+}
+
+size_t GapBuffer::find(char c, size_t from) const {
+    for (size_t i = from; i < size(); i++) {
+        if (at(i) == c) {
+            return i;
+        }
+    }
+    return size();
+}
+
+size_t GapBuffer::rfind(char c, size_t before) const {
+    for (size_t i = std::min(before, size()); i-- > 0;) {
+        if (at(i) == c) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
@@ -0,0 +1,71 @@
+#include "graphics/glyph_cache.h"
+#include <functional>
+
+size_t GlyphKeyHash::operator()(const GlyphKey& key) const {
+    size_t h = std::hash<const void*>()(key.face);
+    h ^= (static_cast<size_t>(key.glyphId) << 16) ^ key.size;
+    h = h * 0x9E3779B97F4A7C15ull + (key.subpixel | (static_cast<size_t>(key.format) << 8));
+    return h ^ (h >> 29);
+}
+
+GlyphCache::GlyphCache(size_t maxBytes) : maxBytes(maxBytes) {}
+
+std::shared_ptr<const CachedGlyph> GlyphCache::find(const GlyphKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return nullptr;
+    }
+
+    // 移动到LRU头部
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+std::shared_ptr<const CachedGlyph> GlyphCache::insert(const GlyphKey& key, CachedGlyph glyph) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    size_t bytes = entryBytes(glyph);
+    evict(bytes);
+
+    auto entry = std::make_shared<const CachedGlyph>(std::move(glyph));
+    lru.emplace_front(key, entry);
+    index[key] = lru.begin();
+    byteSize += bytes;
+    return entry;
+}
+
+void GlyphCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    index.clear();
+    byteSize = 0;
+}
+
+std::vector<std::pair<GlyphKey, std::shared_ptr<const CachedGlyph>>> GlyphCache::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {lru.begin(), lru.end()};
+}
+
+size_t GlyphCache::getByteSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return byteSize;
+}
+
+size_t GlyphCache::entryBytes(const CachedGlyph& glyph) {
+    return sizeof(Entry) + sizeof(CachedGlyph) + glyph.coverage.size();
+}
+
+void GlyphCache::evict(size_t incoming) {
+    while (!lru.empty() && byteSize + incoming > maxBytes) {
+        auto& victim = lru.back();
+        byteSize -= entryBytes(*victim.second);
+        index.erase(victim.first);
+        lru.pop_back();
+    }
+}
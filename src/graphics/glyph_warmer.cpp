@@ -0,0 +1,44 @@
+#include "graphics/glyph_warmer.h"
+#include "graphics/text_renderer.h"
+#include "core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+void GlyphWarmer::warm(const std::vector<Item>& items, unsigned threadCount) {
+    if (items.empty()) {
+        return;
+    }
+    ThreadPool& pool = ThreadPool::getInstance();
+    if (threadCount == 0) {
+        threadCount = static_cast<unsigned>(pool.getThreadCount());
+    }
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, items.size()));
+
+    // 按条目动态领取任务，长短不一的文本也能均匀分配
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        // 每个任务一个渲染器，光栅化使用各自的字体副本，同一字体的字形也能并行生成
+        TextRenderer renderer(true);
+        for (size_t i = next++; i < items.size(); i = next++) {
+            renderer.prerasterize(items[i].text, items[i].style);
+        }
+    };
+
+    // 在共享线程池上执行，调用线程在wait中也会参与
+    TaskGroup group(pool);
+    for (unsigned i = 0; i < threadCount; i++) {
+        group.run(worker);
+    }
+    group.wait();
+}
+
+std::future<void> GlyphWarmer::warmAsync(std::vector<Item> items, unsigned threadCount) {
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> future = promise->get_future();
+    ThreadPool::getInstance().submit([items = std::move(items), threadCount, promise]() {
+        warm(items, threadCount);
+        promise->set_value();
+    });
+    return future;
+}
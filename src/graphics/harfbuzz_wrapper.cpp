@@ -16,8 +16,34 @@ std::vector<IFontRenderer::ShapedGlyph> HarfBuzzWrapper::shapeText(
     const std::string& text,
     const TextStyle& style) {
     
+    return shapeText(font, text, 0, text.size(), style);
+}
+
+std::vector<IFontRenderer::ShapedGlyph> HarfBuzzWrapper::shapeText(
+    hb_font_t* font,
+    const std::string& text,
+    size_t start,
+    size_t length,
+    const TextStyle& style) {
+    
+    hb_direction_t direction = (style.direction == TextStyle::TextDirection::RTL) 
+        ? HB_DIRECTION_RTL 
+        : HB_DIRECTION_LTR;
+    return shapeText(font, text, start, length, direction,
+                     hb_script_from_string(style.script.c_str(), -1), style.language);
+}
+
+std::vector<IFontRenderer::ShapedGlyph> HarfBuzzWrapper::shapeText(
+    hb_font_t* font,
+    const std::string& text,
+    size_t start,
+    size_t length,
+    hb_direction_t direction,
+    hb_script_t script,
+    const std::string& language) {
+    
     std::vector<IFontRenderer::ShapedGlyph> result;
-    if (!font || text.empty()) {
+    if (!font || text.empty() || length == 0) {
         return result;
     }
 
@@ -26,17 +52,13 @@ std::vector<IFontRenderer::ShapedGlyph> HarfBuzzWrapper::shapeText(
     if (!buffer) return result;
     
     // 添加文本到缓冲区
-    hb_buffer_add_utf8(buffer, text.c_str(), -1, 0, -1);
+    hb_buffer_add_utf8(buffer, text.c_str(), static_cast<int>(text.size()),
+                       static_cast<unsigned int>(start), static_cast<int>(length));
     
-    // 设置文本方向
-    hb_direction_t direction = (style.direction == TextStyle::TextDirection::RTL) 
-        ? HB_DIRECTION_RTL 
-        : HB_DIRECTION_LTR;
+    // 设置文本方向、文字系统和语言
     hb_buffer_set_direction(buffer, direction);
-    
-    // 设置文字系统和语言
-    hb_buffer_set_script(buffer, hb_script_from_string(style.script.c_str(), -1));
-    hb_buffer_set_language(buffer, hb_language_from_string(style.language.c_str(), -1));
+    hb_buffer_set_script(buffer, script);
+    hb_buffer_set_language(buffer, hb_language_from_string(language.c_str(), -1));
     
     // 执行文本整形
     hb_shape(font, buffer, nullptr, 0);
@@ -57,6 +79,7 @@ std::vector<IFontRenderer::ShapedGlyph> HarfBuzzWrapper::shapeText(
             glyph.y_advance = glyphPos[i].y_advance / 64.0f;
             glyph.x_offset = glyphPos[i].x_offset / 64.0f;
             glyph.y_offset = glyphPos[i].y_offset / 64.0f;
+            glyph.cluster = glyphInfo[i].cluster;
             result.push_back(glyph);
         }
     }
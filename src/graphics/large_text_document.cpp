@@ -0,0 +1,188 @@
+#include "graphics/large_text_document.h"
+#include "graphics/utf8.h"
+#include <algorithm>
+#include <cstring>
+
+LargeTextDocument::LargeTextDocument() {
+    lineStarts.push_back(0);
+}
+
+LargeTextDocument::~LargeTextDocument() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    indexCondition.notify_one();
+    if (indexThread.joinable()) {
+        indexThread.join();
+    }
+}
+
+void LargeTextDocument::append(const char* data, size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 块写满后才开新块，偏移可以直接换算成块号
+        while (size > 0) {
+            if (chunks.empty() || chunks.back()->size == kChunkSize) {
+                chunks.push_back(std::make_shared<Chunk>());
+            }
+            Chunk& chunk = *chunks.back();
+            size_t count = std::min(size, kChunkSize - chunk.size);
+            std::memcpy(chunk.data.get() + chunk.size, data, count);
+            chunk.size += count;
+            totalSize += count;
+            data += count;
+            size -= count;
+        }
+
+        if (!indexThread.joinable()) {
+            indexThread = std::thread(&LargeTextDocument::indexLoop, this);
+        }
+    }
+    indexCondition.notify_one();
+}
+
+void LargeTextDocument::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    chunks.clear();
+    lineStarts.assign(1, 0);
+    totalSize = 0;
+    indexedSize = 0;
+    generation++;
+}
+
+size_t LargeTextDocument::getSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totalSize;
+}
+
+size_t LargeTextDocument::getLineCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lineStarts.size();
+}
+
+bool LargeTextDocument::isIndexing() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return indexedSize < totalSize;
+}
+
+std::string LargeTextDocument::getLine(size_t index, size_t maxBytes) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string line;
+    if (index >= lineStarts.size()) {
+        return line;
+    }
+
+    size_t start = lineStarts[index];
+    size_t end;
+    if (index + 1 < lineStarts.size()) {
+        end = lineStarts[index + 1] - 1;  // 去掉换行符
+    } else {
+        // 最后一行延伸到下一个换行符之前，未索引部分按需查找
+        end = indexedSize;
+        while (end < totalSize) {
+            const Chunk& chunk = *chunks[end / kChunkSize];
+            const char* base = chunk.data.get();
+            const char* from = base + end % kChunkSize;
+            auto found = static_cast<const char*>(
+                std::memchr(from, '\n', chunk.size - (from - base)));
+            if (found) {
+                end += found - from;
+                break;
+            }
+            end += chunk.size - (from - base);
+        }
+    }
+
+    if (end - start > maxBytes) {
+        end = start + maxBytes;
+        copyRange(start, end, line);
+        // 截断在码点边界上，丢弃被截断的不完整序列
+        size_t lead = line.size();
+        while (lead > 0 && isUtf8Continuation(line[lead - 1])) {
+            lead--;
+        }
+        if (lead > 0) {
+            auto c = static_cast<uint8_t>(line[lead - 1]);
+            size_t length = c < 0x80 ? 1 : (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : 4;
+            if (line.size() - (lead - 1) < length) {
+                line.resize(lead - 1);
+            }
+        }
+    } else {
+        copyRange(start, end, line);
+    }
+
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return line;
+}
+
+void LargeTextDocument::setIndexListener(std::function<void()> listener) {
+    std::lock_guard<std::mutex> lock(mutex);
+    indexListener = std::move(listener);
+}
+
+void LargeTextDocument::copyRange(size_t start, size_t end, std::string& out) const {
+    out.reserve(out.size() + (end - start));
+    while (start < end) {
+        const Chunk& chunk = *chunks[start / kChunkSize];
+        size_t offset = start % kChunkSize;
+        size_t count = std::min(end - start, chunk.size - offset);
+        out.append(chunk.data.get() + offset, count);
+        start += count;
+    }
+}
+
+void LargeTextDocument::indexLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::vector<size_t> found;
+    while (true) {
+        indexCondition.wait(lock, [this] { return quitting || indexedSize < totalSize; });
+        if (quitting) {
+            return;
+        }
+
+        // 在锁内取出要扫描的范围，扫描本身在锁外进行
+        // 已写入的字节不会再被修改，追加只写入chunk->size之后的位置
+        size_t chunkIndex = indexedSize / kChunkSize;
+        std::shared_ptr<Chunk> chunk = chunks[chunkIndex];
+        size_t offset = indexedSize % kChunkSize;
+        size_t end = std::min(chunk->size, offset + kIndexStep);
+        size_t chunkBase = chunkIndex * kChunkSize;
+        uint64_t scanGeneration = generation;
+        lock.unlock();
+
+        found.clear();
+        const char* base = chunk->data.get();
+        const char* p = base + offset;
+        const char* limit = base + end;
+        while (p < limit) {
+            auto newline = static_cast<const char*>(std::memchr(p, '\n', limit - p));
+            if (!newline) {
+                break;
+            }
+            found.push_back(chunkBase + (newline - base) + 1);
+            p = newline + 1;
+        }
+
+        lock.lock();
+        if (scanGeneration != generation) {
+            continue;  // 扫描期间文档被清空
+        }
+        lineStarts.insert(lineStarts.end(), found.begin(), found.end());
+        indexedSize = chunkBase + end;
+
+        auto listener = indexListener;
+        if (listener) {
+            lock.unlock();
+            listener();
+            lock.lock();
+        }
+    }
+}
@@ -0,0 +1,221 @@
+#include "graphics/line_breaker.h"
+#include "graphics/utf8.h"
+
+using LBC = LineBreaker::LineBreakClass;
+
+namespace {
+bool inRange(uint32_t cp, uint32_t lo, uint32_t hi) {
+    return cp >= lo && cp <= hi;
+}
+
+bool isSmallKana(uint32_t cp) {
+    switch (cp) {
+        case 0x3041: case 0x3043: case 0x3045: case 0x3047: case 0x3049:
+        case 0x3063: case 0x3083: case 0x3085: case 0x3087: case 0x308E:
+        case 0x3095: case 0x3096:
+        case 0x30A1: case 0x30A3: case 0x30A5: case 0x30A7: case 0x30A9:
+        case 0x30C3: case 0x30E3: case 0x30E5: case 0x30E7: case 0x30EE:
+        case 0x30F5: case 0x30F6:
+            return true;
+        default:
+            return false;
+    }
+}
+} // namespace
+
+LBC LineBreaker::classify(uint32_t cp) {
+    // ASCII 快速路径
+    if (cp < 0x80) {
+        switch (cp) {
+            case '\n': return LBC::LF;
+            case '\r': return LBC::CR;
+            case 0x0B: case 0x0C: return LBC::BK;
+            case ' ': return LBC::SP;
+            case '\t': return LBC::BA;
+            case '(': case '[': case '{': return LBC::OP;
+            case ')': case ']': return LBC::CP;
+            case '}': return LBC::CL;
+            case '"': case '\'': return LBC::QU;
+            case '!': case '?': return LBC::EX;
+            case ',': case '.': case ':': case ';': return LBC::IS;
+            case '/': return LBC::SY;
+            case '-': return LBC::HY;
+            case '|': return LBC::BA;
+            default: break;
+        }
+        if (cp < 0x20 || cp == 0x7F) return LBC::CM;
+        if (cp >= '0' && cp <= '9') return LBC::NU;
+        return LBC::AL;
+    }
+
+    switch (cp) {
+        case 0x85: case 0x2028: case 0x2029: return LBC::BK;
+        case 0x200B: return LBC::ZW;
+        case 0x200D: return LBC::ZWJ;
+        case 0x200C: return LBC::CM;
+        case 0x2060: case 0xFEFF: return LBC::WJ;
+        case 0xA0: case 0x2007: case 0x202F: case 0x034F: return LBC::GL;
+        case 0xAD: case 0x2010: case 0x2012: case 0x2013: case 0x1680:
+        case 0x205F: case 0x3000: return LBC::BA;
+        case 0xB4: case 0x2C8: case 0x2CC: case 0x2DF: return LBC::BB;
+        case 0xA1: case 0xBF: return LBC::OP;
+        case 0xAB: case 0xBB: case 0x2018: case 0x2019: case 0x201C: case 0x201D:
+            return LBC::QU;
+        case 0x037E: case 0x0589: case 0x060C: case 0x060D: return LBC::IS;
+        case 0x3001: case 0x3002: case 0xFE50: case 0xFE52:
+        case 0xFF0C: case 0xFF0E: case 0xFF61: case 0xFF64:
+            return LBC::CL;
+        case 0x3008: case 0x300A: case 0x300C: case 0x300E: case 0x3010:
+        case 0x3014: case 0x3016: case 0x3018: case 0x301A: case 0x301D:
+        case 0xFF08: case 0xFF3B: case 0xFF5B: case 0xFF5F: case 0xFF62:
+            return LBC::OP;
+        case 0x3009: case 0x300B: case 0x300D: case 0x300F: case 0x3011:
+        case 0x3015: case 0x3017: case 0x3019: case 0x301B: case 0x301E:
+        case 0x301F: case 0xFF09: case 0xFF3D: case 0xFF5D: case 0xFF60:
+        case 0xFF63:
+            return LBC::CL;
+        case 0xFF01: case 0xFF1F: return LBC::EX;
+        case 0xFF1A: case 0xFF1B: case 0x3005: case 0x301C: case 0x303B:
+        case 0x309D: case 0x309E: case 0x30A0: case 0x30FB: case 0x30FC:
+        case 0x30FD: case 0x30FE: case 0x203C: case 0x2047: case 0x2048:
+        case 0x2049:
+            return LBC::NS;
+        default:
+            break;
+    }
+
+    // 组合符号
+    if (inRange(cp, 0x0300, 0x036F) || inRange(cp, 0x0483, 0x0489) ||
+        inRange(cp, 0x0591, 0x05BD) || inRange(cp, 0x0610, 0x061A) ||
+        inRange(cp, 0x064B, 0x065F) || inRange(cp, 0x1AB0, 0x1AFF) ||
+        inRange(cp, 0x1DC0, 0x1DFF) || inRange(cp, 0x20D0, 0x20FF) ||
+        inRange(cp, 0x3099, 0x309A) || inRange(cp, 0xFE00, 0xFE0F) ||
+        inRange(cp, 0xFE20, 0xFE2F) || inRange(cp, 0xE0100, 0xE01EF) ||
+        inRange(cp, 0x80, 0x9F)) {
+        return LBC::CM;
+    }
+
+    if (inRange(cp, 0x2000, 0x2006) || inRange(cp, 0x2008, 0x200A)) {
+        return LBC::BA;
+    }
+
+    if (inRange(cp, 0x0660, 0x0669) || inRange(cp, 0x06F0, 0x06F9) ||
+        inRange(cp, 0x0966, 0x096F)) {
+        return LBC::NU;
+    }
+
+    if (isSmallKana(cp)) {
+        return LBC::NS;
+    }
+
+    // 表意文字、假名、谚文、全角形式和表情符号
+    if (inRange(cp, 0x2E80, 0x2FFF) || inRange(cp, 0x3003, 0x303F) ||
+        inRange(cp, 0x3040, 0x30FF) || inRange(cp, 0x3100, 0x31FF) ||
+        inRange(cp, 0x3200, 0x4DBF) || inRange(cp, 0x4E00, 0x9FFF) ||
+        inRange(cp, 0xA000, 0xA4CF) || inRange(cp, 0xAC00, 0xD7A3) ||
+        inRange(cp, 0xF900, 0xFAFF) || inRange(cp, 0xFE30, 0xFE4F) ||
+        inRange(cp, 0xFF01, 0xFF60) || inRange(cp, 0x1F000, 0x1FAFF) ||
+        inRange(cp, 0x20000, 0x3FFFD)) {
+        return LBC::ID;
+    }
+
+    return LBC::AL;
+}
+
+std::vector<uint8_t> LineBreaker::analyze(const std::string& text) {
+    std::vector<uint8_t> breaks(text.size(), None);
+    if (text.empty()) {
+        return breaks;
+    }
+
+    // 解码码点并记录字节偏移
+    std::vector<uint32_t> offsets;
+    std::vector<LBC> raw;
+    offsets.reserve(text.size());
+    raw.reserve(text.size());
+    for (size_t pos = 0; pos < text.size();) {
+        offsets.push_back(static_cast<uint32_t>(pos));
+        raw.push_back(classify(decodeUtf8(text, pos)));
+    }
+
+    // LB9/LB10: 组合符号继承前一个字符的类别，无法附着时按AL处理
+    std::vector<LBC> cls(raw);
+    std::vector<bool> attached(raw.size(), false);
+    for (size_t i = 0; i < cls.size(); i++) {
+        if (cls[i] != LBC::CM && cls[i] != LBC::ZWJ) {
+            continue;
+        }
+        if (i > 0 && cls[i - 1] != LBC::BK && cls[i - 1] != LBC::CR &&
+            cls[i - 1] != LBC::LF && cls[i - 1] != LBC::ZW &&
+            cls[i - 1] != LBC::SP) {
+            cls[i] = cls[i - 1];
+            attached[i] = true;
+        } else {
+            cls[i] = LBC::AL;
+        }
+    }
+
+    LBC beforeSpaces = cls[0];  // 最近一个非空格字符的类别
+    for (size_t i = 1; i < cls.size(); i++) {
+        LBC prev = cls[i - 1];
+        LBC cur = cls[i];
+        if (prev != LBC::SP) {
+            beforeSpaces = prev;
+        }
+
+        uint8_t result = Allowed;
+        if (prev == LBC::BK || prev == LBC::LF ||
+            (prev == LBC::CR && cur != LBC::LF)) {
+            result = Mandatory;                                   // LB4, LB5
+        } else if (prev == LBC::CR || cur == LBC::BK ||
+                   cur == LBC::CR || cur == LBC::LF) {
+            result = None;                                        // LB5, LB6
+        } else if (cur == LBC::SP || cur == LBC::ZW) {
+            result = None;                                        // LB7
+        } else if (beforeSpaces == LBC::ZW) {
+            result = Allowed;                                     // LB8
+        } else if (raw[i - 1] == LBC::ZWJ || attached[i]) {
+            result = None;                                        // LB8a, LB9
+        } else if (prev == LBC::WJ || cur == LBC::WJ) {
+            result = None;                                        // LB11
+        } else if (prev == LBC::GL) {
+            result = None;                                        // LB12
+        } else if (cur == LBC::GL && prev != LBC::SP &&
+                   prev != LBC::BA && prev != LBC::HY) {
+            result = None;                                        // LB12a
+        } else if (cur == LBC::CL || cur == LBC::CP || cur == LBC::EX ||
+                   cur == LBC::IS || cur == LBC::SY) {
+            result = None;                                        // LB13
+        } else if (beforeSpaces == LBC::OP) {
+            result = None;                                        // LB14
+        } else if (beforeSpaces == LBC::QU && cur == LBC::OP) {
+            result = None;                                        // LB15
+        } else if ((beforeSpaces == LBC::CL || beforeSpaces == LBC::CP) &&
+                   cur == LBC::NS) {
+            result = None;                                        // LB16
+        } else if (prev == LBC::SP) {
+            result = Allowed;                                     // LB18
+        } else if (prev == LBC::QU || cur == LBC::QU) {
+            result = None;                                        // LB19
+        } else if (cur == LBC::BA || cur == LBC::HY || cur == LBC::NS ||
+                   prev == LBC::BB) {
+            result = None;                                        // LB21
+        } else if ((prev == LBC::AL && cur == LBC::NU) ||
+                   (prev == LBC::NU && cur == LBC::AL)) {
+            result = None;                                        // LB23
+        } else if (cur == LBC::NU &&
+                   (prev == LBC::NU || prev == LBC::IS || prev == LBC::SY ||
+                    prev == LBC::CL || prev == LBC::CP)) {
+            result = None;                                        // LB25
+        } else if ((prev == LBC::AL || prev == LBC::IS) && cur == LBC::AL) {
+            result = None;                                        // LB28, LB29
+        } else if (((prev == LBC::AL || prev == LBC::NU) && cur == LBC::OP) ||
+                   (prev == LBC::CP && (cur == LBC::AL || cur == LBC::NU))) {
+            result = None;                                        // LB30
+        }
+
+        breaks[offsets[i]] = result;                              // LB31
+    }
+
+    return breaks;
+}
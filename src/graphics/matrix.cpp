@@ -82,4 +82,22 @@ Rect Matrix::mapRect(const Rect& rect) const {
     float maxY = std::max({p1.y, p2.y, p3.y, p4.y});
     
     return Rect(minX, minY, maxX - minX, maxY - minY);
-} 
\ No newline at end of file
+} 
+
+bool Matrix::invert(Matrix& inverse) const {
+    // 只处理仿射变换，忽略透视分量
+    float det = m[0] * m[4] - m[1] * m[3];
+    if (std::fabs(det) < 1e-12f) {
+        return false;
+    }
+    
+    float invDet = 1.0f / det;
+    inverse = Matrix();
+    inverse.m[0] = m[4] * invDet;
+    inverse.m[1] = -m[1] * invDet;
+    inverse.m[3] = -m[3] * invDet;
+    inverse.m[4] = m[0] * invDet;
+    inverse.m[2] = -(inverse.m[0] * m[2] + inverse.m[1] * m[5]);
+    inverse.m[5] = -(inverse.m[3] * m[2] + inverse.m[4] * m[5]);
+    return true;
+}
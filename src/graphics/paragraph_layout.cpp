@@ -0,0 +1,308 @@
+#include "graphics/paragraph_layout.h"
+#include "graphics/line_breaker.h"
+#include "graphics/utf8.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+namespace {
+const char* const kEllipsis = "\xE2\x80\xA6";  // U+2026
+
+bool isTrailingSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+} // namespace
+
+ParagraphLayout::ParagraphLayout(IFontRenderer& renderer,
+                                 const std::string& text,
+                                 const TextStyle& style,
+                                 int maxWidth,
+                                 const Options& options)
+    : text(text), maxWidth(maxWidth) {
+
+    // 行高和基线取自字体度量，measure和draw使用同一结果
+    auto metrics = renderer.getFontMetrics(style);
+    lineHeight = metrics.getLineHeight();
+    baselineOffset = metrics.getBaselineOffset();
+
+    // 整段只整形一次，之后按字节宽度折行
+    auto advances = renderer.getTextAdvances(text, style);
+    prefix.assign(text.size() + 1, 0.0f);
+    for (size_t i = 0; i < text.size(); i++) {
+        prefix[i + 1] = prefix[i] + (i < advances.size() ? advances[i] : 0.0f);
+    }
+
+    auto breaks = LineBreaker::analyze(text);
+
+    // 按强制换行切分段落，段内收集可换行位置
+    size_t paragraphStart = 0;
+    std::vector<size_t> candidates;
+    for (size_t i = 0; i <= text.size(); i++) {
+        bool mandatory = (i == text.size()) || breaks[i] == LineBreaker::Mandatory;
+        if (!mandatory) {
+            if (breaks[i] == LineBreaker::Allowed) {
+                candidates.push_back(i);
+            }
+            continue;
+        }
+
+        candidates.push_back(i);
+        if (maxWidth <= 0 || paragraphStart == i) {
+            addLine(paragraphStart, i);
+        } else if (options.breakStrategy == BreakStrategy::Greedy ||
+                   !breakBalanced(paragraphStart, i, candidates)) {
+            breakGreedy(paragraphStart, i, candidates);
+        }
+        candidates.clear();
+        paragraphStart = i;
+    }
+
+    // 超出最大行数时截断，并按需在末行添加省略号
+    if (options.maxLines > 0 && lines.size() > static_cast<size_t>(options.maxLines)) {
+        lines.resize(options.maxLines);
+        if (options.ellipsize) {
+            auto ellipsisAdvances = renderer.getTextAdvances(kEllipsis, style);
+            float ellipsisWidth = 0;
+            for (float advance : ellipsisAdvances) {
+                ellipsisWidth += advance;
+            }
+
+            Line& last = lines.back();
+            if (maxWidth > 0) {
+                size_t end = fitCodepoints(last.start, last.end, maxWidth - ellipsisWidth);
+                last.end = trimEnd(last.start, end);
+            }
+            last.width = measure(last.start, last.end) + ellipsisWidth;
+            last.ellipsized = true;
+        }
+    }
+
+    for (const auto& line : lines) {
+        width = std::max(width, line.width);
+    }
+}
+
+std::string ParagraphLayout::getLineText(size_t index) const {
+    const Line& line = lines[index];
+    std::string result = text.substr(line.start, line.end - line.start);
+    if (line.ellipsized) {
+        result += kEllipsis;
+    }
+    return result;
+}
+
+bool ParagraphLayout::isValidForWidth(int availableWidth) const {
+    if (availableWidth == maxWidth) {
+        return true;
+    }
+    bool ellipsized = !lines.empty() && lines.back().ellipsized;
+    if (softWrapped || ellipsized) {
+        return false;
+    }
+    // 没有自动折行时，只要放得下最宽行结果就不变
+    return availableWidth <= 0 || availableWidth >= std::ceil(width);
+}
+
+size_t ParagraphLayout::trimEnd(size_t start, size_t end) const {
+    while (end > start && isTrailingSpace(text[end - 1])) {
+        end--;
+    }
+    return end;
+}
+
+size_t ParagraphLayout::fitCodepoints(size_t start, size_t end, float available) const {
+    size_t fit = start;
+    size_t pos = start;
+    while (pos < end) {
+        size_t next = pos;
+        decodeUtf8(text.data(), end, next);
+        
+        // 零宽的码点（组合符号等）与前一个字符一起断开
+        while (next < end && !isTrailingSpace(text[next])) {
+            size_t probe = next;
+            decodeUtf8(text.data(), end, probe);
+            if (measure(next, probe) != 0.0f) {
+                break;
+            }
+            next = probe;
+        }
+        
+        if (measure(start, next) > available) {
+            break;
+        }
+        fit = next;
+        pos = next;
+    }
+    return fit;
+}
+
+void ParagraphLayout::addLine(size_t start, size_t end) {
+    Line line;
+    line.start = start;
+    line.end = trimEnd(start, end);
+    line.width = measure(line.start, line.end);
+    lines.push_back(line);
+}
+
+void ParagraphLayout::breakGreedy(size_t start, size_t end,
+                                  const std::vector<size_t>& candidates) {
+    size_t next = 0;
+    while (start < end) {
+        // 找到行宽不超过maxWidth的最远换行机会
+        while (next < candidates.size() && candidates[next] <= start) {
+            next++;
+        }
+        size_t lastFit = start;
+        size_t i = next;
+        while (i < candidates.size() &&
+               measure(start, trimEnd(start, candidates[i])) <= maxWidth) {
+            lastFit = candidates[i];
+            i++;
+        }
+
+        if (lastFit == start) {
+            // 单词比整行还宽，按码点强制断开，每行至少一个字符
+            lastFit = fitCodepoints(start, candidates[next], maxWidth);
+            if (lastFit == start) {
+                size_t pos = start;
+                decodeUtf8(text, pos);
+                lastFit = std::min(pos, end);
+            }
+        }
+
+        if (lastFit < end) {
+            softWrapped = true;
+        }
+        addLine(start, lastFit);
+        start = lastFit;
+    }
+}
+
+bool ParagraphLayout::breakBalanced(size_t start, size_t end,
+                                    const std::vector<size_t>& candidates) {
+    // 节点为段首和所有换行机会，cost按(行数, 空白平方和)字典序比较
+    std::vector<size_t> nodes;
+    nodes.push_back(start);
+    for (size_t candidate : candidates) {
+        if (candidate > start && candidate <= end) {
+            nodes.push_back(candidate);
+        }
+    }
+
+    struct Cost {
+        int lines = std::numeric_limits<int>::max();
+        float slack = 0;
+        bool operator<(const Cost& other) const {
+            return lines != other.lines ? lines < other.lines : slack < other.slack;
+        }
+    };
+
+    std::vector<Cost> best(nodes.size());
+    std::vector<size_t> from(nodes.size(), 0);
+    best[0] = {0, 0.0f};
+
+    for (size_t j = 1; j < nodes.size(); j++) {
+        bool isLast = (j == nodes.size() - 1);
+        for (size_t i = j; i-- > 0;) {
+            float lineWidth = measure(nodes[i], trimEnd(nodes[i], nodes[j]));
+            if (lineWidth > maxWidth) {
+                break;  // 行首再往前只会更宽
+            }
+            if (best[i].lines == std::numeric_limits<int>::max()) {
+                continue;
+            }
+            float gap = isLast ? 0.0f : maxWidth - lineWidth;
+            Cost cost{best[i].lines + 1, best[i].slack + gap * gap};
+            if (cost < best[j]) {
+                best[j] = cost;
+                from[j] = i;
+            }
+        }
+    }
+
+    if (best.back().lines == std::numeric_limits<int>::max()) {
+        return false;  // 存在放不下的单词，交给贪心算法强制断开
+    }
+
+    std::vector<size_t> path;
+    for (size_t j = nodes.size() - 1; j > 0; j = from[j]) {
+        path.push_back(j);
+    }
+    size_t lineStart = start;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        size_t lineEnd = nodes[*it];
+        if (lineEnd < end) {
+            softWrapped = true;
+        }
+        addLine(lineStart, lineEnd);
+        lineStart = lineEnd;
+    }
+    return true;
+}
+
+ParagraphLayoutCache& ParagraphLayoutCache::getInstance() {
+    static ParagraphLayoutCache instance;
+    return instance;
+}
+
+size_t ParagraphLayoutCache::KeyHash::operator()(const Key& key) const {
+    size_t h = std::hash<std::string>()(key.text);
+    auto combine = [&h](size_t v) {
+        h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    };
+    combine(std::hash<std::string>()(key.fontName));
+    combine(static_cast<size_t>(key.size));
+    combine(static_cast<size_t>(key.direction));
+    combine(std::hash<std::string>()(key.language));
+    combine(std::hash<std::string>()(key.script));
+    combine(static_cast<size_t>(key.maxWidth));
+    combine(static_cast<size_t>(key.options.breakStrategy));
+    combine(static_cast<size_t>(key.options.maxLines));
+    combine(static_cast<size_t>(key.options.ellipsize));
+    return h;
+}
+
+std::shared_ptr<const ParagraphLayout> ParagraphLayoutCache::get(
+    IFontRenderer& renderer,
+    const std::string& text,
+    const TextStyle& style,
+    int maxWidth,
+    const ParagraphLayout::Options& options) {
+
+    // 颜色不影响排版，不参与键
+    Key key{text, style.fontName, style.size, style.direction,
+            style.language, style.script, maxWidth, options};
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+    }
+
+    // 排版在锁外进行
+    auto layout = std::make_shared<const ParagraphLayout>(
+        renderer, text, style, maxWidth, options);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        return it->second->second;
+    }
+    lru.emplace_front(key, layout);
+    index[std::move(key)] = lru.begin();
+    if (lru.size() > kMaxEntries) {
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return layout;
+}
+
+void ParagraphLayoutCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    index.clear();
+}
@@ -9,7 +9,22 @@ void DrawRectCommand::execute(RenderContext& context) {
 }
 
 void DrawTextCommand::execute(RenderContext& context) {
-    context.drawText(text, x, y, paint);
+    if (!blob) {
+        IFontRenderer* renderer = context.getFontRenderer();
+        if (!renderer) {
+            return;
+        }
+        TextStyle style;
+        style.size = static_cast<int>(paint.getTextSize());
+        blob = renderer->makeTextBlob(text, style);
+    }
+    context.drawTextBlob(*blob, x, y, paint);
+}
+
+void DrawTextBlobCommand::execute(RenderContext& context) {
+    if (blob) {
+        context.drawTextBlob(*blob, x, y, paint);
+    }
 }
 
 // 添加更多渲染命令的实现... 
\ No newline at end of file
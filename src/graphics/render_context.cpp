@@ -217,6 +217,13 @@ void RenderContext::drawText(const std::string& text, float x, float y, const Pa
     style.color = paint.getColor();
     style.color.a = static_cast<uint8_t>(style.color.a * currentState.alpha);
 
+    // 距离场文本在完整的变换下采样，缩放和旋转不需要重新光栅化
+    if (paint.isDistanceFieldText()) {
+        fontRenderer->renderTextTransformed(
+            currentBitmap, text, style, currentState.transform, x, y);
+        return;
+    }
+
     // 应用当前变换
     Point transformed = currentState.transform.mapPoint(Point(x, y));
 
@@ -228,4 +235,28 @@ void RenderContext::drawText(const std::string& text, float x, float y, const Pa
         static_cast<int>(transformed.x),
         static_cast<int>(transformed.y)
     );
-}
\ No newline at end of file
+}
+
+void RenderContext::drawTextBlob(const TextBlob& blob, float x, float y, const Paint& paint) {
+    if (!checkSurface() || !currentBitmap || blob.isEmpty()) {
+        return;
+    }
+
+    Color color = paint.getColor();
+    color.a = static_cast<uint8_t>(color.a * currentState.alpha);
+
+    if (paint.isDistanceFieldText()) {
+        fontRenderer->renderTextBlobTransformed(
+            currentBitmap, blob, color, currentState.transform, x, y);
+        return;
+    }
+
+    Point transformed = currentState.transform.mapPoint(Point(x, y));
+    fontRenderer->renderTextBlob(
+        currentBitmap,
+        blob,
+        color,
+        static_cast<int>(transformed.x),
+        static_cast<int>(transformed.y)
+    );
+}
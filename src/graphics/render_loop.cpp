@@ -19,9 +19,16 @@ RenderLoop::~RenderLoop() {
 }
 
 void RenderLoop::start() {
-    if (isRunning) {
+    if (isRunning.exchange(true)) {
         return;
     }
+
+    // 先在渲染线程上建好Looper和Handler，再启动会投递任务的Choreographer
+    std::promise<void> ready;
+    std::future<void> looperReady = ready.get_future();
+    renderThread = std::thread(&RenderLoop::run, this, std::move(ready));
+    renderThreadId = renderThread.get_id();
+    looperReady.wait();
     
     auto& choreographer = Choreographer::getInstance();
     
@@ -29,38 +36,52 @@ void RenderLoop::start() {
     
     // 注册渲染回调
     choreographer.postFrameCallback([this](int64_t frameTimeNanos) {
-        // 执行具体的渲染逻辑
-        Application::getInstance().render();
+        // 在渲染线程上执行具体的渲染逻辑，帧通道先于积压的普通任务
+        post([]() { Application::getInstance().render(); }, MessagePriority::Frame);
     });
     
     // 启动 Choreographer
     choreographer.start();
-
-    isRunning = true;
-    renderThread = std::thread(&RenderLoop::run, this);
-    renderThreadId = renderThread.get_id();
 }
 
 void RenderLoop::stop() {
-    if (!isRunning) {
+    if (!isRunning.exchange(false)) {
         return;
     }
-    
-    isRunning = false;
+
+    // 让渲染线程退出loop，之后不再进入
+    {
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        if (taskHandler) {
+            taskHandler->post([]() { Looper::quit(); });
+        }
+    }
     if (renderThread.joinable()) {
         renderThread.join();
     }
 }
 
-void RenderLoop::post(std::function<void()> task) {
-    if (!isRunning) {
+void RenderLoop::post(InlineCallback task) {
+    std::lock_guard<std::mutex> lock(handlerMutex);
+    if (!taskHandler) {
         return;
     }
     taskHandler->post(std::move(task));
 }
 
-void RenderLoop::postDelayed(std::function<void()> task, int64_t delayMillis) {
-    if (!isRunning) {
+bool RenderLoop::post(InlineCallback task, MessagePriority priority) {
+    std::lock_guard<std::mutex> lock(handlerMutex);
+    if (!taskHandler) {
+        return false;
+    }
+    bool async = priority == MessagePriority::Input || priority == MessagePriority::Frame;
+    taskHandler->post(std::move(task), priority, async);
+    return true;
+}
+
+void RenderLoop::postDelayed(InlineCallback task, int64_t delayMillis) {
+    std::lock_guard<std::mutex> lock(handlerMutex);
+    if (!taskHandler) {
         return;
     }
     taskHandler->postDelayed(std::move(task), delayMillis);
@@ -84,19 +105,29 @@ bool RenderLoop::isPaused() const {
     return isPausedFlag;
 }
 
-void RenderLoop::run() {
+void RenderLoop::run(std::promise<void> ready) {
     // 在渲染线程中创建 looper
     Looper::prepare();
     looper = std::unique_ptr<Looper>(Looper::getCurrentThreadLooper());
-    taskHandler = std::make_unique<Handler>(looper.get());
-    renderThreadId = std::this_thread::get_id();
+    // 空闲处理只使用到下一帧之前的空闲时间
+    looper->getQueue()->setFrameTimeProvider([]() {
+        return Choreographer::getInstance().getNextFrameTimeNanos();
+    });
+    {
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        taskHandler = std::make_unique<Handler>(looper.get());
+    }
+    ready.set_value();
 
     while (isRunning) {
         looper->loop();
         // TODO: 添加渲染相关的处理逻辑--通过Choreographer
     }
 
-    // 清理资源
-    taskHandler.reset();
+    // 清理资源，正在投递的线程完成后才销毁Handler，之后的投递直接返回
+    {
+        std::lock_guard<std::mutex> lock(handlerMutex);
+        taskHandler.reset();
+    }
     looper.reset();
 } 
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "graphics/shape_cache.h"
+#include <functional>
+
+size_t ShapeKeyHash::operator()(const ShapeKey& key) const {
+    size_t h = std::hash<std::string>()(key.text);
+    h ^= std::hash<const void*>()(key.face) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    h ^= (static_cast<size_t>(key.script) << 17) ^ (static_cast<size_t>(key.size) << 1) ^ key.rtl;
+    h ^= std::hash<std::string>()(key.language) + (h << 6) + (h >> 2);
+    return h;
+}
+
+ShapeCache::ShapeCache(size_t maxEntries) : maxEntries(maxEntries) {}
+
+std::shared_ptr<const ShapedGlyphs> ShapeCache::find(const ShapeKey& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return nullptr;
+    }
+
+    // 移动到LRU头部
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+std::shared_ptr<const ShapedGlyphs> ShapeCache::insert(const ShapeKey& key, ShapedGlyphs glyphs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->second;
+    }
+
+    auto entry = std::make_shared<const ShapedGlyphs>(std::move(glyphs));
+    lru.emplace_front(key, entry);
+    index[key] = lru.begin();
+    if (lru.size() > maxEntries) {
+        index.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return entry;
+}
+
+void ShapeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    index.clear();
+}
+
+std::vector<std::pair<ShapeKey, std::shared_ptr<const ShapedGlyphs>>> ShapeCache::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {lru.begin(), lru.end()};
+}
+
+size_t ShapeCache::getSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
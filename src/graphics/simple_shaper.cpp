@@ -0,0 +1,123 @@
+#include "graphics/simple_shaper.h"
+#include "graphics/font_registry.h"
+#include FT_ADVANCES_H
+#include FT_TRUETYPE_TABLES_H
+#include FT_TRUETYPE_TAGS_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMPLE_SHAPER_SSE2 1
+#endif
+
+namespace {
+// 与hb-ft取前进宽度时使用的加载参数一致
+constexpr FT_Int32 kAdvanceLoadFlags = FT_LOAD_DEFAULT | FT_LOAD_NO_HINTING;
+
+bool hasTable(FT_Face face, FT_ULong tag) {
+    FT_ULong length = 0;
+    return FT_Load_Sfnt_Table(face, tag, 0, nullptr, &length) == 0 && length > 0;
+}
+
+// 从pos开始逐个检查，遇到不满足条件的码点返回false
+bool isSimpleTail(const uint8_t* bytes, size_t pos, size_t length) {
+    while (pos < length) {
+        uint8_t c = bytes[pos];
+        if (c >= 0x20 && c < 0x7F) {
+            pos++;
+            continue;
+        }
+        // Latin-1补充区的双字节形式：C2 A0-BF、C3 80-BF
+        if (pos + 1 >= length) {
+            return false;
+        }
+        uint8_t next = bytes[pos + 1];
+        if (c == 0xC2) {
+            if (next < 0xA0 || next > 0xBF || next == 0xAD) {
+                return false;
+            }
+        } else if (c == 0xC3) {
+            if (next < 0x80 || next > 0xBF) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+        pos += 2;
+    }
+    return true;
+}
+
+Latin1Table* getLatin1Table(FontFace& font, int size) {
+    auto& table = font.latin1Tables[size];
+    if (!table) {
+        table = std::make_unique<Latin1Table>();
+        for (uint32_t cp = 0x20; cp < 0x100; cp++) {
+            FT_UInt glyph = FT_Get_Char_Index(font.ftFace, cp);
+            table->glyphs[cp] = glyph;
+            FT_Fixed advance = 0;
+            if (glyph != 0 && FT_Get_Advance(font.ftFace, glyph, kAdvanceLoadFlags, &advance) == 0) {
+                // 16.16 -> 26.6，取整方式与hb-ft相同
+                table->advances[cp] = ((advance + (1 << 9)) >> 10) / 64.0f;
+            }
+        }
+    }
+    return table.get();
+}
+} // namespace
+
+bool SimpleShaper::isSimpleText(const char* data, size_t length) {
+    auto bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t pos = 0;
+
+#ifdef SIMPLE_SHAPER_SSE2
+    // 每次检查16字节是否都是可打印ASCII，有例外时交给逐字节检查
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    for (; pos + 16 <= length; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + pos));
+        // 有符号比较：0x80以上的字节为负数，同样小于0x20
+        __m128i bad = _mm_or_si128(_mm_cmplt_epi8(chunk, space), _mm_cmpeq_epi8(chunk, del));
+        if (_mm_movemask_epi8(bad) != 0) {
+            break;
+        }
+    }
+#endif
+
+    return isSimpleTail(bytes, pos, length);
+}
+
+bool SimpleShaper::supportsFace(FT_Face face) {
+    if (!face || !FT_IS_SFNT(face)) {
+        return false;
+    }
+    return !hasTable(face, TTAG_GSUB) && !hasTable(face, TTAG_GPOS) &&
+           !hasTable(face, TTAG_kern) && !hasTable(face, TTAG_morx) &&
+           !hasTable(face, FT_MAKE_TAG('k', 'e', 'r', 'x'));
+}
+
+bool SimpleShaper::shape(FontFace& font, int size, const std::string& text, ShapedGlyphs& glyphs) {
+    const Latin1Table* table = getLatin1Table(font, size);
+    auto bytes = reinterpret_cast<const uint8_t*>(text.data());
+
+    glyphs.clear();
+    glyphs.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size()) {
+        uint32_t cluster = static_cast<uint32_t>(pos);
+        uint32_t cp = bytes[pos];
+        if (cp >= 0x80) {
+            cp = ((cp & 0x1F) << 6) | (bytes[pos + 1] & 0x3F);
+            pos += 2;
+        } else {
+            pos++;
+        }
+
+        // 缺字时HarfBuzz可能做空格替换等回退处理，这里不模仿
+        uint32_t glyph = table->glyphs[cp];
+        if (glyph == 0) {
+            return false;
+        }
+        glyphs.push_back({glyph, table->advances[cp], 0.0f, 0.0f, 0.0f, cluster});
+    }
+    return true;
+}
@@ -0,0 +1,372 @@
+#include "graphics/text_disk_cache.h"
+#include "core/logger.h"
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+LOG_TAG("TextDiskCache");
+
+namespace {
+constexpr uint32_t kMagic = 0x46435854;  // "TXCF"
+constexpr uint32_t kFormatVersion = 2;
+constexpr size_t kHashSample = 64 * 1024;
+
+enum RecordType : uint32_t {
+    kGlyphRecord = 1,
+    kShapeRecord = 2
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t freetypeVersion;
+    uint32_t harfbuzzVersion;
+    uint32_t generation;  // 每次写回加一，两个文件中取较大的
+    uint32_t recordCount;
+};
+
+struct RecordHeader {
+    uint32_t type;
+    uint32_t length;  // 不含记录头
+};
+
+struct GlyphHeader {
+    uint64_t fontHash;
+    uint32_t glyphId;
+    uint16_t size;
+    uint8_t subpixel;
+    uint8_t format;
+    int32_t width;
+    int32_t rows;
+    int32_t left;
+    int32_t top;
+};
+
+struct ShapeHeader {
+    uint64_t fontHash;
+    uint16_t size;
+    uint8_t rtl;
+    uint8_t reserved;
+    uint32_t script;
+    uint32_t languageLength;
+    uint32_t textLength;
+    uint32_t glyphCount;
+};
+
+uint32_t freetypeVersion() {
+    return (FREETYPE_MAJOR << 16) | (FREETYPE_MINOR << 8) | FREETYPE_PATCH;
+}
+
+uint32_t harfbuzzVersion() {
+    unsigned major = 0, minor = 0, micro = 0;
+    hb_version(&major, &minor, &micro);
+    return (major << 16) | (minor << 8) | micro;
+}
+
+// FNV-1a
+struct Fnv {
+    uint64_t value = 0xCBF29CE484222325ull;
+
+    void add(const void* data, size_t size) {
+        auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            value = (value ^ bytes[i]) * 0x100000001B3ull;
+        }
+    }
+
+    template <typename T>
+    void add(const T& field) { add(&field, sizeof(T)); }
+};
+
+uint64_t glyphKeyHash(uint64_t fontHash, uint32_t glyphId, uint16_t size,
+                      uint8_t subpixel, uint8_t format) {
+    Fnv fnv;
+    fnv.add(fontHash);
+    fnv.add(glyphId);
+    fnv.add(size);
+    fnv.add(subpixel);
+    fnv.add(format);
+    return fnv.value;
+}
+
+uint64_t shapeKeyHash(uint64_t fontHash, uint16_t size, bool rtl, uint32_t script,
+                      const char* language, size_t languageLength,
+                      const char* text, size_t textLength) {
+    Fnv fnv;
+    fnv.add(fontHash);
+    fnv.add(size);
+    fnv.add(static_cast<uint8_t>(rtl));
+    fnv.add(script);
+    fnv.add(language, languageLength);
+    fnv.add(text, textLength);
+    return fnv.value;
+}
+
+size_t glyphBytes(const GlyphHeader& glyph) {
+    size_t bytesPerPixel = glyph.format == static_cast<uint8_t>(GlyphFormat::Lcd) ? 3 : 1;
+    return static_cast<size_t>(glyph.width) * glyph.rows * bytesPerPixel;
+}
+
+// 映射内存中的字段可能不对齐，统一用memcpy读取
+template <typename T>
+T load(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename T>
+void append(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+std::string slotPath(const std::string& path, int slot) {
+    return path + (slot == 0 ? ".0" : ".1");
+}
+
+bool headerMatches(const FileHeader& header) {
+    return header.magic == kMagic && header.formatVersion == kFormatVersion &&
+           header.freetypeVersion == freetypeVersion() &&
+           header.harfbuzzVersion == harfbuzzVersion();
+}
+
+// 只读文件头取代数，文件不存在或版本不符时返回false
+bool readGeneration(const std::string& path, uint32_t& generation) {
+    std::ifstream stream(path, std::ios::binary);
+    FileHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) || !headerMatches(header)) {
+        return false;
+    }
+    generation = header.generation;
+    return true;
+}
+} // namespace
+
+uint64_t TextDiskCache::hashFontFile(const uint8_t* data, size_t size) {
+    Fnv fnv;
+    fnv.add(static_cast<uint64_t>(size));
+    size_t head = std::min(size, kHashSample);
+    fnv.add(data, head);
+    if (size > head) {
+        size_t tail = std::min(size - head, kHashSample);
+        fnv.add(data + size - tail, tail);
+    }
+    return fnv.value;
+}
+
+bool TextDiskCache::open(const std::string& path) {
+    basePath = path;
+
+    // 代数较新的在前，它损坏时退回另一个
+    uint32_t generations[2] = {0, 0};
+    bool present[2];
+    for (int slot = 0; slot < 2; slot++) {
+        present[slot] = readGeneration(slotPath(path, slot), generations[slot]);
+    }
+    int order[2] = {0, 1};
+    if (present[1] && (!present[0] || generations[1] > generations[0])) {
+        std::swap(order[0], order[1]);
+    }
+
+    for (int slot : order) {
+        // 首次运行时文件不存在，写回后下次启动生效
+        if (!present[slot] || !file.open(slotPath(path, slot))) {
+            continue;
+        }
+        if (!buildIndex()) {
+            LOGI("Discarding stale or corrupt text cache: %s", slotPath(path, slot).c_str());
+            glyphIndex.clear();
+            shapeIndex.clear();
+            file.close();
+            continue;
+        }
+        mappedSlot = slot;
+        mappedGeneration = generations[slot];
+        LOGI("Text cache mapped: %zu glyphs, %zu shaped runs",
+             glyphIndex.size(), shapeIndex.size());
+        return true;
+    }
+    return false;
+}
+
+bool TextDiskCache::buildIndex() {
+    const uint8_t* data = file.data();
+    size_t size = file.size();
+    if (size < sizeof(FileHeader)) {
+        return false;
+    }
+
+    auto header = load<FileHeader>(data);
+    if (!headerMatches(header)) {
+        return false;
+    }
+
+    // 只读取各记录的键建立索引，字形数据在命中时才访问
+    size_t offset = sizeof(FileHeader);
+    for (uint32_t i = 0; i < header.recordCount; i++) {
+        if (size - offset < sizeof(RecordHeader)) {
+            return false;
+        }
+        auto record = load<RecordHeader>(data + offset);
+        size_t payload = offset + sizeof(RecordHeader);
+        if (record.length > size - payload) {
+            return false;
+        }
+
+        if (record.type == kGlyphRecord) {
+            if (record.length < sizeof(GlyphHeader)) {
+                return false;
+            }
+            auto glyph = load<GlyphHeader>(data + payload);
+            if (glyph.width < 0 || glyph.rows < 0 ||
+                glyphBytes(glyph) != record.length - sizeof(GlyphHeader)) {
+                return false;
+            }
+            glyphIndex.emplace(glyphKeyHash(glyph.fontHash, glyph.glyphId, glyph.size,
+                                            glyph.subpixel, glyph.format),
+                               payload);
+        } else if (record.type == kShapeRecord) {
+            if (record.length < sizeof(ShapeHeader)) {
+                return false;
+            }
+            auto shape = load<ShapeHeader>(data + payload);
+            size_t expected = sizeof(ShapeHeader) + size_t(shape.languageLength) +
+                              shape.textLength +
+                              size_t(shape.glyphCount) * sizeof(IFontRenderer::ShapedGlyph);
+            if (expected != record.length) {
+                return false;
+            }
+            const char* strings = reinterpret_cast<const char*>(data + payload + sizeof(ShapeHeader));
+            shapeIndex.emplace(shapeKeyHash(shape.fontHash, shape.size, shape.rtl != 0,
+                                            shape.script, strings, shape.languageLength,
+                                            strings + shape.languageLength, shape.textLength),
+                               payload);
+        }
+        // 未知类型的记录跳过
+
+        offset = payload + record.length;
+    }
+    return true;
+}
+
+bool TextDiskCache::findGlyph(uint64_t fontHash, const GlyphKey& key, CachedGlyph& glyph) const {
+    if (glyphIndex.empty()) {
+        return false;
+    }
+    auto format = static_cast<uint8_t>(key.format);
+    auto range = glyphIndex.equal_range(
+        glyphKeyHash(fontHash, key.glyphId, key.size, key.subpixel, format));
+    for (auto it = range.first; it != range.second; ++it) {
+        const uint8_t* payload = file.data() + it->second;
+        auto header = load<GlyphHeader>(payload);
+        if (header.fontHash != fontHash || header.glyphId != key.glyphId ||
+            header.size != key.size || header.subpixel != key.subpixel ||
+            header.format != format) {
+            continue;
+        }
+        glyph.width = header.width;
+        glyph.rows = header.rows;
+        glyph.left = header.left;
+        glyph.top = header.top;
+        const uint8_t* coverage = payload + sizeof(GlyphHeader);
+        glyph.coverage.assign(coverage, coverage + glyphBytes(header));
+        return true;
+    }
+    return false;
+}
+
+bool TextDiskCache::findShape(uint64_t fontHash, const ShapeKey& key, ShapedGlyphs& glyphs) const {
+    if (shapeIndex.empty()) {
+        return false;
+    }
+    auto range = shapeIndex.equal_range(
+        shapeKeyHash(fontHash, key.size, key.rtl, static_cast<uint32_t>(key.script),
+                     key.language.data(), key.language.size(),
+                     key.text.data(), key.text.size()));
+    for (auto it = range.first; it != range.second; ++it) {
+        const uint8_t* payload = file.data() + it->second;
+        auto header = load<ShapeHeader>(payload);
+        const char* language = reinterpret_cast<const char*>(payload + sizeof(ShapeHeader));
+        const char* text = language + header.languageLength;
+        if (header.fontHash != fontHash || header.size != key.size ||
+            (header.rtl != 0) != key.rtl ||
+            header.script != static_cast<uint32_t>(key.script) ||
+            key.language.compare(0, std::string::npos, language, header.languageLength) != 0 ||
+            key.text.compare(0, std::string::npos, text, header.textLength) != 0) {
+            continue;
+        }
+        glyphs.resize(header.glyphCount);
+        std::memcpy(glyphs.data(), text + header.textLength,
+                    glyphs.size() * sizeof(IFontRenderer::ShapedGlyph));
+        return true;
+    }
+    return false;
+}
+
+bool TextDiskCache::write(const std::vector<GlyphRecord>& glyphs,
+                          const std::vector<ShapeRecord>& shapes) const {
+    if (basePath.empty()) {
+        return false;
+    }
+    // 映射中的文件保持不动，总是写另一个；同一次运行中多次写回覆盖的是同一个文件
+    std::string path = slotPath(basePath, mappedSlot == 0 ? 1 : 0);
+
+    std::string out;
+    FileHeader header{kMagic, kFormatVersion, freetypeVersion(), harfbuzzVersion(),
+                      mappedGeneration + 1,
+                      static_cast<uint32_t>(glyphs.size() + shapes.size())};
+    append(out, header);
+
+    for (const auto& record : glyphs) {
+        const CachedGlyph& glyph = *record.glyph;
+        append(out, RecordHeader{kGlyphRecord,
+                                 static_cast<uint32_t>(sizeof(GlyphHeader) + glyph.coverage.size())});
+        append(out, GlyphHeader{record.fontHash, record.key.glyphId, record.key.size,
+                                record.key.subpixel, static_cast<uint8_t>(record.key.format),
+                                glyph.width, glyph.rows, glyph.left, glyph.top});
+        out.append(reinterpret_cast<const char*>(glyph.coverage.data()), glyph.coverage.size());
+    }
+
+    for (const auto& record : shapes) {
+        const ShapeKey& key = record.key;
+        size_t glyphBytes = record.glyphs->size() * sizeof(IFontRenderer::ShapedGlyph);
+        append(out, RecordHeader{kShapeRecord,
+                                 static_cast<uint32_t>(sizeof(ShapeHeader) + key.language.size() +
+                                                       key.text.size() + glyphBytes)});
+        append(out, ShapeHeader{record.fontHash, key.size, static_cast<uint8_t>(key.rtl), 0,
+                                static_cast<uint32_t>(key.script),
+                                static_cast<uint32_t>(key.language.size()),
+                                static_cast<uint32_t>(key.text.size()),
+                                static_cast<uint32_t>(record.glyphs->size())});
+        out += key.language;
+        out += key.text;
+        out.append(reinterpret_cast<const char*>(record.glyphs->data()), glyphBytes);
+    }
+
+    // 先写临时文件再改名，进程中途退出不会留下半个缓存文件
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+    std::string temp = path + ".tmp";
+    {
+        std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+        if (!stream.write(out.data(), out.size())) {
+            LOGE("Failed to write text cache: %s", temp.c_str());
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        LOGE("Failed to replace text cache %s: %s", path.c_str(), ec.message().c_str());
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    LOGI("Text cache written: %zu glyphs, %zu shaped runs, %zu bytes",
+         glyphs.size(), shapes.size(), out.size());
+    return true;
+}
@@ -0,0 +1,318 @@
+#include "graphics/text_itemizer.h"
+#include "graphics/utf8.h"
+#include <algorithm>
+#include <numeric>
+
+using BC = TextItemizer::BidiClass;
+
+namespace {
+bool inRange(uint32_t cp, uint32_t lo, uint32_t hi) {
+    return cp >= lo && cp <= hi;
+}
+
+bool isNeutral(BC c) {
+    return c == BC::B || c == BC::S || c == BC::WS || c == BC::ON;
+}
+
+// N1中数字按R处理
+BC strongDirection(BC c) {
+    return c == BC::L ? BC::L : BC::R;
+}
+} // namespace
+
+BC TextItemizer::classify(uint32_t cp) {
+    // ASCII 快速路径
+    if (cp < 0x80) {
+        if (cp >= '0' && cp <= '9') return BC::EN;
+        if ((cp >= 'A' && cp <= 'Z') || (cp >= 'a' && cp <= 'z')) return BC::L;
+        switch (cp) {
+            case '\n': case '\r': case 0x1C: case 0x1D: case 0x1E: return BC::B;
+            case '\t': case 0x0B: case 0x1F: return BC::S;
+            case ' ': case 0x0C: return BC::WS;
+            case '+': case '-': return BC::ES;
+            case '#': case '$': case '%': return BC::ET;
+            case ',': case '.': case '/': case ':': return BC::CS;
+            default: break;
+        }
+        return cp < 0x20 || cp == 0x7F ? BC::BN : BC::ON;
+    }
+
+    switch (cp) {
+        case 0x85: case 0x2029: return BC::B;
+        case 0xA0: return BC::CS;
+        case 0x2028: case 0x3000: return BC::WS;
+        case 0xA2: case 0xA3: case 0xA4: case 0xA5: case 0xB0: case 0xB1:
+        case 0x2030: case 0x2031: case 0x20AC:
+            return BC::ET;
+        case 0x200B: case 0x200C: case 0x200D: case 0xAD: case 0xFEFF: return BC::BN;
+        case 0x200E: return BC::L;
+        case 0x200F: return BC::R;
+        case 0x061C: return BC::AL;
+        case 0x060C: return BC::CS;
+        default: break;
+    }
+
+    if (inRange(cp, 0x2000, 0x200A)) return BC::WS;
+    if (inRange(cp, 0x20A0, 0x20CF)) return BC::ET;
+    if (inRange(cp, 0x202A, 0x202E) || inRange(cp, 0x2060, 0x206F)) return BC::BN;
+
+    // 组合符号
+    if (inRange(cp, 0x0300, 0x036F) || inRange(cp, 0x0483, 0x0489) ||
+        inRange(cp, 0x0591, 0x05BD) || cp == 0x05BF || inRange(cp, 0x05C1, 0x05C2) ||
+        inRange(cp, 0x05C4, 0x05C5) || cp == 0x05C7 || inRange(cp, 0x0610, 0x061A) ||
+        inRange(cp, 0x064B, 0x065F) || cp == 0x0670 || inRange(cp, 0x06D6, 0x06DC) ||
+        inRange(cp, 0x06DF, 0x06E4) || inRange(cp, 0x06E7, 0x06E8) ||
+        inRange(cp, 0x06EA, 0x06ED) || inRange(cp, 0x08D3, 0x08FF) ||
+        inRange(cp, 0x1AB0, 0x1AFF) || inRange(cp, 0x1DC0, 0x1DFF) ||
+        inRange(cp, 0x20D0, 0x20FF) || inRange(cp, 0xFE00, 0xFE0F) ||
+        inRange(cp, 0xFE20, 0xFE2F) || inRange(cp, 0xE0100, 0xE01EF)) {
+        return BC::NSM;
+    }
+
+    // 阿拉伯数字
+    if (inRange(cp, 0x0660, 0x0669) || inRange(cp, 0x066B, 0x066C) ||
+        inRange(cp, 0x0600, 0x0605) || cp == 0x06DD) {
+        return BC::AN;
+    }
+    if (inRange(cp, 0x06F0, 0x06F9) || inRange(cp, 0xFF10, 0xFF19) ||
+        inRange(cp, 0x2070, 0x2079) || inRange(cp, 0x2080, 0x2089)) {
+        return BC::EN;
+    }
+
+    // 希伯来文及其它从右到左的文字
+    if (inRange(cp, 0x0590, 0x05FF) || inRange(cp, 0x07C0, 0x085F) ||
+        inRange(cp, 0xFB1D, 0xFB4F) || inRange(cp, 0x10800, 0x10FFF) ||
+        inRange(cp, 0x1E800, 0x1EDFF)) {
+        return BC::R;
+    }
+
+    // 阿拉伯文、叙利亚文、它拿字母
+    if (inRange(cp, 0x0600, 0x07BF) || inRange(cp, 0x0860, 0x08FF) ||
+        inRange(cp, 0xFB50, 0xFDFF) || inRange(cp, 0xFE70, 0xFEFF) ||
+        inRange(cp, 0x1EE00, 0x1EEFF)) {
+        return BC::AL;
+    }
+
+    // 常见的中性标点和符号
+    if (inRange(cp, 0xA1, 0xBF) || inRange(cp, 0x2010, 0x2027) ||
+        inRange(cp, 0x2032, 0x205E) || inRange(cp, 0x2100, 0x214F) ||
+        inRange(cp, 0x2190, 0x2BFF) || inRange(cp, 0x3001, 0x3004) ||
+        inRange(cp, 0x3008, 0x3020) || inRange(cp, 0xFE30, 0xFE4F) ||
+        inRange(cp, 0xFF01, 0xFF0F) || inRange(cp, 0xFF1A, 0xFF20) ||
+        inRange(cp, 0x1F000, 0x1FAFF)) {
+        return BC::ON;
+    }
+
+    return BC::L;
+}
+
+std::vector<uint8_t> TextItemizer::resolveLevels(std::vector<BidiClass> t,
+                                                 uint8_t paragraphLevel) {
+    const size_t n = t.size();
+    const std::vector<BC> original(t);
+    const BC sos = (paragraphLevel & 1) ? BC::R : BC::L;  // 没有显式嵌入时sos与eos相同
+
+    // W1: NSM取前一个字符的类别，BN同样附着在前一个字符上
+    BC prev = sos;
+    for (size_t i = 0; i < n; i++) {
+        if (t[i] == BC::NSM || t[i] == BC::BN) {
+            t[i] = prev;
+        }
+        prev = t[i];
+    }
+
+    // W2: 前面最近的强类别为AL时，EN改为AN
+    BC lastStrong = sos;
+    for (size_t i = 0; i < n; i++) {
+        if (t[i] == BC::L || t[i] == BC::R || t[i] == BC::AL) {
+            lastStrong = t[i];
+        } else if (t[i] == BC::EN && lastStrong == BC::AL) {
+            t[i] = BC::AN;
+        }
+    }
+
+    // W3
+    std::replace(t.begin(), t.end(), BC::AL, BC::R);
+
+    // W4: 数字之间的单个分隔符
+    for (size_t i = 1; i + 1 < n; i++) {
+        if (t[i] == BC::ES && t[i - 1] == BC::EN && t[i + 1] == BC::EN) {
+            t[i] = BC::EN;
+        } else if (t[i] == BC::CS && t[i - 1] == t[i + 1] &&
+                   (t[i - 1] == BC::EN || t[i - 1] == BC::AN)) {
+            t[i] = t[i - 1];
+        }
+    }
+
+    // W5: 与EN相邻的ET序列
+    for (size_t i = 0; i < n;) {
+        if (t[i] != BC::ET) {
+            i++;
+            continue;
+        }
+        size_t j = i;
+        while (j < n && t[j] == BC::ET) {
+            j++;
+        }
+        if ((i > 0 && t[i - 1] == BC::EN) || (j < n && t[j] == BC::EN)) {
+            std::fill(t.begin() + i, t.begin() + j, BC::EN);
+        }
+        i = j;
+    }
+
+    // W6
+    for (auto& c : t) {
+        if (c == BC::ES || c == BC::ET || c == BC::CS) {
+            c = BC::ON;
+        }
+    }
+
+    // W7: 前面最近的强类别为L时，EN改为L
+    lastStrong = sos;
+    for (size_t i = 0; i < n; i++) {
+        if (t[i] == BC::L || t[i] == BC::R) {
+            lastStrong = t[i];
+        } else if (t[i] == BC::EN && lastStrong == BC::L) {
+            t[i] = BC::L;
+        }
+    }
+
+    // N1/N2: 中性字符两侧方向一致时取该方向，否则取嵌入方向
+    for (size_t i = 0; i < n;) {
+        if (!isNeutral(t[i])) {
+            i++;
+            continue;
+        }
+        size_t j = i;
+        while (j < n && isNeutral(t[j])) {
+            j++;
+        }
+        BC before = i == 0 ? sos : strongDirection(t[i - 1]);
+        BC after = j == n ? sos : strongDirection(t[j]);
+        std::fill(t.begin() + i, t.begin() + j, before == after ? before : sos);
+        i = j;
+    }
+
+    // I1/I2
+    std::vector<uint8_t> levels(n, paragraphLevel);
+    for (size_t i = 0; i < n; i++) {
+        if ((paragraphLevel & 1) == 0) {
+            if (t[i] == BC::R) {
+                levels[i] += 1;
+            } else if (t[i] == BC::AN || t[i] == BC::EN) {
+                levels[i] += 2;
+            }
+        } else if (t[i] == BC::L || t[i] == BC::EN || t[i] == BC::AN) {
+            levels[i] += 1;
+        }
+    }
+
+    // L1: 段落分隔符、制表符及其之前和行尾的空白恢复为段落层级
+    bool trailing = true;
+    for (size_t i = n; i-- > 0;) {
+        BC c = original[i];
+        if (c == BC::B || c == BC::S) {
+            levels[i] = paragraphLevel;
+            trailing = true;
+        } else if (c == BC::WS || c == BC::BN) {
+            if (trailing) {
+                levels[i] = paragraphLevel;
+            }
+        } else {
+            trailing = false;
+        }
+    }
+
+    return levels;
+}
+
+std::vector<TextItemizer::Item> TextItemizer::itemize(const std::string& text, bool rtl) {
+    std::vector<Item> items;
+    if (text.empty()) {
+        return items;
+    }
+
+    std::vector<size_t> offsets;
+    std::vector<BC> classes;
+    std::vector<hb_script_t> scripts;
+    offsets.reserve(text.size());
+    classes.reserve(text.size());
+    scripts.reserve(text.size());
+
+    // Common和Inherited并入前一个确定的书写系统
+    hb_unicode_funcs_t* funcs = hb_unicode_funcs_get_default();
+    hb_script_t lastScript = HB_SCRIPT_COMMON;
+    size_t firstResolved = std::string::npos;
+    for (size_t pos = 0; pos < text.size();) {
+        offsets.push_back(pos);
+        uint32_t cp = decodeUtf8(text, pos);
+        classes.push_back(classify(cp));
+
+        hb_script_t script = hb_unicode_script(funcs, cp);
+        if (script == HB_SCRIPT_COMMON || script == HB_SCRIPT_INHERITED ||
+            script == HB_SCRIPT_UNKNOWN) {
+            script = lastScript;
+        } else {
+            if (firstResolved == std::string::npos) {
+                firstResolved = scripts.size();
+            }
+            lastScript = script;
+        }
+        scripts.push_back(script);
+    }
+    // 开头的Common字符跟随第一个确定的书写系统
+    if (firstResolved != std::string::npos) {
+        std::fill(scripts.begin(), scripts.begin() + firstResolved, scripts[firstResolved]);
+    }
+
+    auto levels = resolveLevels(std::move(classes), rtl ? 1 : 0);
+
+    // 层级或书写系统变化处切分
+    for (size_t i = 0; i < offsets.size(); i++) {
+        if (items.empty() || items.back().level != levels[i] ||
+            items.back().script != scripts[i]) {
+            Item item;
+            item.start = offsets[i];
+            item.level = levels[i];
+            item.script = scripts[i];
+            items.push_back(item);
+        }
+        size_t end = i + 1 < offsets.size() ? offsets[i + 1] : text.size();
+        items.back().length = end - items.back().start;
+    }
+    return items;
+}
+
+std::vector<size_t> TextItemizer::reorder(const std::vector<Item>& items) {
+    std::vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (items.empty()) {
+        return order;
+    }
+
+    uint8_t highest = 0;
+    uint8_t lowestOdd = 0xFF;
+    for (const auto& item : items) {
+        highest = std::max(highest, item.level);
+        if (item.isRtl()) {
+            lowestOdd = std::min(lowestOdd, item.level);
+        }
+    }
+
+    // L2: 从最高层级到最低奇数层级，逐级反转不低于该层级的连续片段
+    for (int level = highest; level >= lowestOdd && level > 0; level--) {
+        for (size_t i = 0; i < order.size();) {
+            if (items[order[i]].level < level) {
+                i++;
+                continue;
+            }
+            size_t j = i;
+            while (j < order.size() && items[order[j]].level >= level) {
+                j++;
+            }
+            std::reverse(order.begin() + i, order.begin() + j);
+            i = j;
+        }
+    }
+    return order;
+}
@@ -1,82 +1,338 @@
 #include "graphics/text_renderer.h"
+#include "graphics/utf8.h"
+#include "graphics/distance_field.h"
+#include <algorithm>
+#include <cmath>
 
-TextRenderer::TextRenderer() {
-    ftWrapper.initialize();
+namespace {
+// 组合符号、连接符和空白等，优先留在当前字体的run中
+bool isRunExtender(uint32_t cp) {
+    return cp == 0x20 || cp == 0xA0 || cp == 0x3000 ||
+           (cp >= 0x0300 && cp <= 0x036F) ||
+           (cp >= 0x1AB0 && cp <= 0x1AFF) ||
+           (cp >= 0x1DC0 && cp <= 0x1DFF) ||
+           (cp >= 0x200C && cp <= 0x200D) ||
+           (cp >= 0x20D0 && cp <= 0x20FF) ||
+           (cp >= 0xFE00 && cp <= 0xFE0F) ||
+           (cp >= 0xFE20 && cp <= 0xFE2F) ||
+           (cp >= 0x1F3FB && cp <= 0x1F3FF) ||
+           (cp >= 0xE0100 && cp <= 0xE01EF);
 }
 
+CachedGlyph copyGlyphSlot(const FT_GlyphSlot slot) {
+    const FT_Bitmap& ftBitmap = slot->bitmap;
+    
+    // LCD位图每个像素占3字节，width记录的是像素宽度
+    int rowBytes = ftBitmap.width;
+    CachedGlyph glyph;
+    glyph.width = ftBitmap.pixel_mode == FT_PIXEL_MODE_LCD ? rowBytes / 3 : rowBytes;
+    glyph.rows = ftBitmap.rows;
+    glyph.left = slot->bitmap_left;
+    glyph.top = slot->bitmap_top;
+    glyph.coverage.resize(static_cast<size_t>(rowBytes) * glyph.rows);
+    for (int row = 0; row < glyph.rows; row++) {
+        std::copy_n(ftBitmap.buffer + row * ftBitmap.pitch, rowBytes,
+                    glyph.coverage.data() + row * rowBytes);
+    }
+    return glyph;
+}
+} // namespace
+
+TextRenderer::TextRenderer(bool privateFaces) : usePrivateFaces(privateFaces) {}
+
 TextRenderer::~TextRenderer() {
-    for (auto& [name, context] : fonts) {
-        if (context->hb_font) {
-            hbWrapper.destroyFont(context->hb_font);
-        }
-        if (context->ft_face) {
-            ftWrapper.destroyFace(context->ft_face);
+    for (auto& [font, privateFace] : privateFaces) {
+        if (privateFace.face) {
+            FontRegistry::getInstance().destroyFaceClone(privateFace.face);
         }
     }
-    ftWrapper.cleanup();
 }
 
 bool TextRenderer::loadFont(const std::string& fontPath, const std::string& name) {
-    auto context = std::make_unique<FontContext>();
-    context->path = fontPath;
+    // 只在注册表中登记，字体文件在首次使用时才映射
+    return FontRegistry::getInstance().registerFont(name, fontPath);
+}
+
+void TextRenderer::setFallbackFonts(
+    const std::string& name,
+    const std::vector<std::string>& fallbacks) {
     
-    // 加载 FreeType 字体
-    FT_Error error = ftWrapper.loadFace(fontPath, &context->ft_face);
-    if (error) {
-        return false;
+    FontRegistry::getInstance().setFallbackFonts(name, fallbacks);
+}
+
+const std::vector<FontEntry*>& TextRenderer::getFontChain(const std::string& name) {
+    auto& registry = FontRegistry::getInstance();
+    uint64_t generation = registry.getGeneration();
+    if (generation != chainGeneration) {
+        resolvedChains.clear();
+        chainGeneration = generation;
     }
     
-    // 创建 HarfBuzz 字体
-    context->hb_font = hbWrapper.createFont(context->ft_face);
-    if (!context->hb_font) {
-        ftWrapper.destroyFace(context->ft_face);
-        return false;
+    auto cached = resolvedChains.find(name);
+    if (cached != resolvedChains.end()) {
+        return cached->second;
     }
-    
-    fonts[name] = std::move(context);
-    return true;
+    return resolvedChains[name] = registry.getFontChain(name);
 }
 
-std::vector<IFontRenderer::ShapedGlyph> TextRenderer::shapeText(
+std::vector<TextRenderer::ShapedRun> TextRenderer::shapeText(
     const std::string& text,
     const TextStyle& style) {
     
-    auto it = fonts.find(style.fontName);
-    if (it == fonts.end()) {
+    const auto& chain = getFontChain(style.fontName);
+    if (chain.empty() || text.empty()) {
         return {};
     }
     
-    return hbWrapper.shapeText(it->second->hb_font, text, style);
+    // 段落方向取自样式，各片段的方向和书写系统由分项结果决定
+    auto items = TextItemizer::itemize(
+        text, style.direction == TextStyle::TextDirection::RTL);
+    
+    std::vector<ShapedRun> runs;
+    for (size_t index : TextItemizer::reorder(items)) {
+        shapeItem(text, items[index], chain, style, runs);
+    }
+    return runs;
 }
 
-void TextRenderer::renderShapedText(
-    Bitmap* bitmap,
-    const std::vector<ShapedGlyph>& shaped,
+void TextRenderer::shapeItem(
+    const std::string& text,
+    const TextItemizer::Item& item,
+    const std::vector<FontEntry*>& chain,
     const TextStyle& style,
-    int x, int y) {
+    std::vector<ShapedRun>& runs) {
     
-    auto it = fonts.find(style.fontName);
-    if (it == fonts.end()) {
-        return;
+    // 按覆盖每个码点的第一个字体切分run
+    size_t firstRun = runs.size();
+    FontFace* runFont = nullptr;
+    size_t runStart = item.start;
+    size_t end = item.start + item.length;
+    size_t pos = item.start;
+    
+    auto flush = [&](size_t runEnd) {
+        if (runFont && runEnd > runStart) {
+            ShapedRun run;
+            run.font = runFont;
+            run.offset = runStart;
+            run.glyphs = shapeRun(*runFont, text.substr(runStart, runEnd - runStart),
+                                  item, style);
+            runs.push_back(std::move(run));
+        }
+    };
+    
+    while (pos < end) {
+        size_t charStart = pos;
+        uint32_t cp = decodeUtf8(text.data(), end, pos);
+        
+        FontFace* font = nullptr;
+        if (runFont && isRunExtender(cp) && runFont->coverage.covers(cp)) {
+            font = runFont;
+        } else {
+            // 后备字体只有在前面的字体都缺字时才会被打开
+            for (FontEntry* entry : chain) {
+                FontFace* candidate = entry->getFace();
+                if (candidate && candidate->coverage.covers(cp)) {
+                    font = candidate;
+                    break;
+                }
+            }
+            if (!font) {
+                // 没有字体覆盖时留在当前run，由字体绘制.notdef
+                font = runFont ? runFont : chain.front()->getFace();
+                if (!font) {
+                    continue;
+                }
+            }
+        }
+        
+        if (font != runFont) {
+            flush(charStart);
+            runFont = font;
+            runStart = charStart;
+        }
     }
+    flush(end);
     
-    float pen_x = x;
-    float pen_y = y;
+    // 从右到左的片段内，按字体切分的run也要倒序排列
+    if (item.isRtl()) {
+        std::reverse(runs.begin() + firstRun, runs.end());
+    }
+}
+
+std::shared_ptr<const ShapedGlyphs> TextRenderer::shapeRun(
+    FontFace& font,
+    const std::string& text,
+    const TextItemizer::Item& item,
+    const TextStyle& style) {
     
-    for (const auto& glyph : shaped) {
-        if (ftWrapper.renderGlyph(it->second->ft_face, glyph.glyphId, style.size)) {
-            int glyph_x = pen_x + glyph.x_offset;
-            int glyph_y = pen_y - it->second->ft_face->glyph->bitmap_top + glyph.y_offset;
-            
-            ftWrapper.drawGlyphBitmap(bitmap,
-                                    it->second->ft_face->glyph->bitmap,
-                                    glyph_x,
-                                    glyph_y,
-                                    style.color);
+    auto& registry = FontRegistry::getInstance();
+    ShapeCache& shapeCache = registry.getShapeCache();
+    ShapeKey key{text, font.ftFace, static_cast<uint16_t>(style.size),
+                 item.isRtl(), item.script, style.language};
+    if (auto cached = shapeCache.find(key)) {
+        return cached;
+    }
+    
+    ShapedGlyphs glyphs;
+    if (registry.getDiskCache().findShape(font.fileHash, key, glyphs)) {
+        return shapeCache.insert(key, std::move(glyphs));
+    }
+    registry.notifyCacheMiss();
+    {
+        std::lock_guard<std::mutex> lock(font.mutex);
+        font.setPixelSize(style.size);
+        // 简单文本直接查表，结果与HarfBuzz相同
+        if (font.simpleShaping && !item.isRtl() &&
+            SimpleShaper::isSimpleText(text.data(), text.size()) &&
+            SimpleShaper::shape(font, style.size, text, glyphs)) {
+            return shapeCache.insert(key, std::move(glyphs));
+        }
+        glyphs = hbWrapper.shapeText(font.hbFont, text, 0, text.size(),
+                                     item.isRtl() ? HB_DIRECTION_RTL : HB_DIRECTION_LTR,
+                                     item.script, style.language);
+    }
+    return shapeCache.insert(key, std::move(glyphs));
+}
+
+std::shared_ptr<const TextBlob> TextRenderer::makeTextBlob(
+    const std::vector<ShapedRun>& runs,
+    const TextStyle& style) {
+    
+    std::vector<TextBlob::Run> blobRuns;
+    blobRuns.reserve(runs.size());
+    float pen_x = 0;
+    float pen_y = 0;
+    float minX = 0, maxX = 0, minY = 0, maxY = 0;
+    float ascent = 0;
+    float descent = 0;
+    
+    for (const auto& run : runs) {
+        if (run.glyphs->empty()) {
+            continue;
+        }
+        TextBlob::Run blobRun;
+        blobRun.font = run.font;
+        blobRun.glyphIds.reserve(run.glyphs->size());
+        blobRun.positions.reserve(run.glyphs->size());
+        for (const auto& glyph : *run.glyphs) {
+            float glyph_x = pen_x + glyph.x_offset;
+            float glyph_y = pen_y + glyph.y_offset;
+            blobRun.glyphIds.push_back(glyph.glyphId);
+            blobRun.positions.push_back({glyph_x, glyph_y});
+            minX = std::min(minX, glyph_x);
+            maxX = std::max(maxX, glyph_x);
+            minY = std::min(minY, glyph_y);
+            maxY = std::max(maxY, glyph_y);
+            pen_x += glyph.x_advance;
+            pen_y += glyph.y_advance;
+        }
+        blobRuns.push_back(std::move(blobRun));
+        
+        {
+            std::lock_guard<std::mutex> lock(run.font->mutex);
+            run.font->setPixelSize(style.size);
+            const FT_Size_Metrics& metrics = run.font->ftFace->size->metrics;
+            ascent = std::max(ascent, metrics.ascender / 64.0f);
+            descent = std::max(descent, -metrics.descender / 64.0f);
         }
-        pen_x += glyph.x_advance;
-        pen_y += glyph.y_advance;
     }
+    
+    TextBlob::Bounds bounds;
+    bounds.left = minX;
+    bounds.right = std::max(maxX, pen_x);
+    bounds.top = minY - ascent;
+    bounds.bottom = maxY + descent;
+    return std::make_shared<const TextBlob>(style.size, std::move(blobRuns), pen_x, bounds);
+}
+
+std::shared_ptr<const CachedGlyph> TextRenderer::getGlyph(
+    FontFace& font,
+    uint32_t glyphId,
+    int size,
+    int subpixel,
+    GlyphFormat format) {
+    
+    auto& registry = FontRegistry::getInstance();
+    GlyphCache& glyphCache = registry.getGlyphCache();
+    GlyphKey key{font.ftFace, glyphId, static_cast<uint16_t>(size),
+                 static_cast<uint8_t>(subpixel), format};
+    if (auto cached = glyphCache.find(key)) {
+        return cached;
+    }
+    
+    CachedGlyph stored;
+    if (registry.getDiskCache().findGlyph(font.fileHash, key, stored)) {
+        return glyphCache.insert(key, std::move(stored));
+    }
+    registry.notifyCacheMiss();
+    
+    // 26.6格式下一个像素为64，每个相位偏移64/kSubpixelPhases
+    FT_Pos shift = subpixel * (64 / GlyphCache::kSubpixelPhases);
+    auto render = [&](FT_Face face) {
+        bool rendered = format == GlyphFormat::Lcd
+            ? ftWrapper.renderGlyphLcd(face, glyphId, shift)
+            : ftWrapper.renderGlyph(face, glyphId, shift);
+        return rendered ? glyphCache.insert(key, copyGlyphSlot(face->glyph)) : nullptr;
+    };
+    
+    // 私有副本只有本线程使用，光栅化不加锁，只有写入共享缓存时加锁
+    if (FT_Face face = getPrivateFace(font, size)) {
+        return render(face);
+    }
+    std::lock_guard<std::mutex> lock(font.mutex);
+    font.setPixelSize(size);
+    return render(font.ftFace);
+}
+
+std::shared_ptr<const CachedGlyph> TextRenderer::getDistanceField(
+    FontFace& font,
+    uint32_t glyphId) {
+    
+    auto& registry = FontRegistry::getInstance();
+    GlyphCache& glyphCache = registry.getGlyphCache();
+    GlyphKey key{font.ftFace, glyphId, static_cast<uint16_t>(kDistanceFieldSize), 0,
+                 GlyphFormat::DistanceField};
+    if (auto cached = glyphCache.find(key)) {
+        return cached;
+    }
+    
+    CachedGlyph stored;
+    if (registry.getDiskCache().findGlyph(font.fileHash, key, stored)) {
+        return glyphCache.insert(key, std::move(stored));
+    }
+    registry.notifyCacheMiss();
+    
+    // 每个字形只在参考字号下生成一次，之后任意字号和变换都复用
+    auto render = [&](FT_Face face) -> std::shared_ptr<const CachedGlyph> {
+        if (!ftWrapper.renderGlyphDistanceField(face, glyphId)) {
+            return nullptr;
+        }
+        return glyphCache.insert(key, copyGlyphSlot(face->glyph));
+    };
+    
+    if (FT_Face face = getPrivateFace(font, kDistanceFieldSize)) {
+        return render(face);
+    }
+    std::lock_guard<std::mutex> lock(font.mutex);
+    font.setPixelSize(kDistanceFieldSize);
+    return render(font.ftFace);
+}
+
+FT_Face TextRenderer::getPrivateFace(FontFace& font, int size) {
+    if (!usePrivateFaces) {
+        return nullptr;
+    }
+    auto [it, inserted] = privateFaces.try_emplace(&font);
+    PrivateFace& privateFace = it->second;
+    if (inserted) {
+        // 创建失败时保留空条目，之后直接使用共享字体
+        privateFace.face = FontRegistry::getInstance().createFaceClone(font);
+    }
+    if (privateFace.face && privateFace.size != size) {
+        FT_Set_Pixel_Sizes(privateFace.face, 0, size);
+        privateFace.size = size;
+    }
+    return privateFace.face;
 }
 
 void TextRenderer::renderText(
@@ -85,33 +341,175 @@ void TextRenderer::renderText(
     const TextStyle& style,
     int x, int y) {
     
-    auto shaped = shapeText(text, style);
-    renderShapedText(bitmap, shaped, style, x, y);
+    renderTextBlob(bitmap, *makeTextBlob(text, style), style.color, x, y);
+}
+
+void TextRenderer::renderTextTransformed(
+    Bitmap* bitmap,
+    const std::string& text,
+    const TextStyle& style,
+    const Matrix& matrix,
+    float x, float y) {
+    
+    renderTextBlobTransformed(bitmap, *makeTextBlob(text, style), style.color, matrix, x, y);
+}
+
+std::shared_ptr<const TextBlob> TextRenderer::makeTextBlob(
+    const std::string& text,
+    const TextStyle& style) {
+    
+    return makeTextBlob(shapeText(text, style), style);
+}
+
+void TextRenderer::renderTextBlob(
+    Bitmap* bitmap,
+    const TextBlob& blob,
+    Color color,
+    int x, int y) {
+    
+    // LCD遮罩按BGRA8888的字节顺序混合，其它目标格式使用灰度遮罩
+    bool lcd = subpixelOrder != SubpixelOrder::None && bitmap &&
+               bitmap->getFormat().baseFormat == BasePixelFormat::BGRA8888;
+    GlyphFormat format = lcd ? GlyphFormat::Lcd : GlyphFormat::Coverage;
+    
+    for (const auto& run : blob.getRuns()) {
+        for (size_t i = 0; i < run.glyphIds.size(); i++) {
+            const auto& position = run.positions[i];
+            // 整数部分决定绘制位置，小数部分选择子像素相位
+            float glyph_pos = x + position.x;
+            int glyph_x = static_cast<int>(std::floor(glyph_pos));
+            int subpixel = static_cast<int>(
+                (glyph_pos - glyph_x) * GlyphCache::kSubpixelPhases + 0.5f);
+            if (subpixel == GlyphCache::kSubpixelPhases) {
+                glyph_x++;
+                subpixel = 0;
+            }
+            
+            auto cached = getGlyph(*run.font, run.glyphIds[i], blob.getTextSize(),
+                                   subpixel, format);
+            if (!cached) {
+                continue;
+            }
+            int glyph_y = static_cast<int>(y + position.y) - cached->top;
+            if (lcd) {
+                ftWrapper.drawGlyphLcdMask(bitmap, *cached,
+                                           glyph_x + cached->left,
+                                           glyph_y,
+                                           color, subpixelOrder);
+            } else {
+                ftWrapper.drawGlyphMask(bitmap, *cached,
+                                        glyph_x + cached->left,
+                                        glyph_y,
+                                        color);
+            }
+        }
+    }
+}
+
+void TextRenderer::renderTextBlobTransformed(
+    Bitmap* bitmap,
+    const TextBlob& blob,
+    Color color,
+    const Matrix& matrix,
+    float x, float y) {
+    
+    // 字形位置仍使用目标字号下的整形结果，只有字形图像来自距离场
+    float fieldScale = static_cast<float>(blob.getTextSize()) / kDistanceFieldSize;
+    
+    for (const auto& run : blob.getRuns()) {
+        for (size_t i = 0; i < run.glyphIds.size(); i++) {
+            float glyph_x = x + run.positions[i].x;
+            float glyph_y = y + run.positions[i].y;
+            
+            if (auto field = getDistanceField(*run.font, run.glyphIds[i])) {
+                // 距离场像素 -> 文本坐标 -> 设备坐标
+                Matrix fieldToText = Matrix::makeTranslate(
+                    glyph_x + field->left * fieldScale,
+                    glyph_y - field->top * fieldScale) *
+                    Matrix::makeScale(fieldScale, fieldScale);
+                drawDistanceField(bitmap, *field, matrix * fieldToText, color);
+            } else if (auto cached = getGlyph(*run.font, run.glyphIds[i],
+                                              blob.getTextSize(), 0)) {
+                // 不支持距离场时退回到只变换位置的普通字形
+                Point origin = matrix.mapPoint(Point(glyph_x, glyph_y));
+                ftWrapper.drawGlyphMask(bitmap, *cached,
+                                        static_cast<int>(origin.x) + cached->left,
+                                        static_cast<int>(origin.y) - cached->top,
+                                        color);
+            }
+        }
+    }
 }
 
 Size TextRenderer::getTextSize(
     const std::string& text,
     const TextStyle& style) {
     
-    auto shaped = shapeText(text, style);
-    if (shaped.empty()) {
+    auto runs = shapeText(text, style);
+    if (runs.empty()) {
         return {0, 0};
     }
     
     float width = 0;
     float height = 0;
     
-    auto it = fonts.find(style.fontName);
-    if (it == fonts.end()) {
-        return {0, 0};
+    for (const auto& run : runs) {
+        std::lock_guard<std::mutex> lock(run.font->mutex);
+        run.font->setPixelSize(style.size);
+        for (const auto& glyph : *run.glyphs) {
+            auto metrics = ftWrapper.getGlyphMetrics(run.font->ftFace, glyph.glyphId);
+            width += glyph.x_advance;
+            height = std::max(height, static_cast<float>(metrics.height));
+        }
     }
     
-    for (const auto& glyph : shaped) {
-        auto metrics = ftWrapper.getGlyphMetrics(
-            it->second->ft_face, glyph.glyphId, style.size);
-        width += glyph.x_advance;
-        height = std::max(height, static_cast<float>(metrics.height));
+    return {static_cast<int>(width), static_cast<int>(height)};
+}
+
+void TextRenderer::prerasterize(const std::string& text, const TextStyle& style) {
+    auto blob = makeTextBlob(text, style);
+    for (const auto& run : blob->getRuns()) {
+        for (size_t i = 0; i < run.glyphIds.size(); i++) {
+            // 按整数原点下的子像素相位光栅化，与renderTextBlob的取法一致
+            float glyph_pos = run.positions[i].x;
+            int subpixel = static_cast<int>(
+                (glyph_pos - std::floor(glyph_pos)) * GlyphCache::kSubpixelPhases + 0.5f);
+            getGlyph(*run.font, run.glyphIds[i], blob->getTextSize(),
+                     subpixel % GlyphCache::kSubpixelPhases,
+                     subpixelOrder != SubpixelOrder::None ? GlyphFormat::Lcd
+                                                          : GlyphFormat::Coverage);
+        }
+    }
+}
+
+IFontRenderer::FontMetrics TextRenderer::getFontMetrics(const TextStyle& style) {
+    const auto& chain = getFontChain(style.fontName);
+    FontFace* font = chain.empty() ? nullptr : chain.front()->getFace();
+    if (!font) {
+        return FontMetrics::estimate(static_cast<float>(style.size));
     }
     
-    return {static_cast<int>(width), static_cast<int>(height)};
-} 
\ No newline at end of file
+    std::lock_guard<std::mutex> lock(font->mutex);
+    auto cached = font->metricsBySize.find(style.size);
+    if (cached != font->metricsBySize.end()) {
+        return cached->second;
+    }
+    font->setPixelSize(style.size);
+    return font->metricsBySize[style.size] = ftWrapper.getFontMetrics(font->ftFace);
+}
+
+std::vector<float> TextRenderer::getTextAdvances(
+    const std::string& text,
+    const TextStyle& style) {
+    
+    std::vector<float> advances(text.size(), 0.0f);
+    for (const auto& run : shapeText(text, style)) {
+        for (const auto& glyph : *run.glyphs) {
+            size_t cluster = run.offset + glyph.cluster;
+            if (cluster < advances.size()) {
+                advances[cluster] += glyph.x_advance;
+            }
+        }
+    }
+    return advances;
+}
@@ -1,6 +1,7 @@
 #include "platform/win32/win32_surface.h"
 #include "platform/event_translator.h"
 #include "core/event_dispatcher.h"
+#include "graphics/render_loop.h"
 #include "core/logger.h"
 #include <stdexcept>
 
@@ -253,7 +254,13 @@ LRESULT CALLBACK Win32Surface::WndProc(HWND hwnd, UINT msg,
                 // 统一的事件转换和分发逻辑
                 MSG winMsg = {hwnd, msg, wParam, lParam};
                 if (translator.translateNativeEvent(&winMsg, event)) {
-                    EventDispatcher::getInstance().dispatchEvent(event);
+                    // 渲染循环运行时在渲染线程上经输入通道分发，先于帧和普通任务；否则直接分发
+                    bool posted = RenderLoop::getInstance().post([event]() mutable {
+                        EventDispatcher::getInstance().dispatchEvent(event);
+                    }, MessagePriority::Input);
+                    if (!posted) {
+                        EventDispatcher::getInstance().dispatchEvent(event);
+                    }
                 }
                 break;
             }
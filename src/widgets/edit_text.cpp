@@ -0,0 +1,191 @@
+#include "widgets/edit_text.h"
+#include "view/measure_spec.h"
+#include "application/application.h"
+#include "graphics/utf8.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cmath>
+
+LOG_TAG("EditText");
+
+EditText::EditText() : EditText("") {}
+
+EditText::EditText(const std::string& text) : buffer(text), cursor(text.size()) {
+    textPaint.setTextSize(16.0f);  // 默认字体大小
+    textPaint.setColor(Color::Black());  // 默认颜色
+    cursorPaint.setColor(Color::Black());
+    cursorPaint.setStrokeWidth(1.0f);
+}
+
+void EditText::setText(const std::string& text) {
+    buffer = GapBuffer(text);
+    cursor = buffer.size();
+    // 整体替换文本时全量排版
+    textLayout.reset();
+    requestLayout();
+    invalidate();
+}
+
+void EditText::insert(const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    size_t linesBefore = textLayout ? textLayout->getLineCount() : 0;
+    size_t pos = cursor;
+    buffer.insert(pos, text);
+    cursor = pos + text.size();
+    if (textLayout) {
+        textLayout->onInsert(buffer, pos, text.size());
+    }
+    onTextChanged(linesBefore);
+}
+
+void EditText::erase(size_t pos, size_t length) {
+    pos = std::min(pos, buffer.size());
+    length = std::min(length, buffer.size() - pos);
+    if (length == 0) {
+        return;
+    }
+    size_t linesBefore = textLayout ? textLayout->getLineCount() : 0;
+    buffer.erase(pos, length);
+    if (cursor > pos) {
+        cursor = cursor >= pos + length ? cursor - length : pos;
+    }
+    if (textLayout) {
+        textLayout->onErase(buffer, pos, length);
+    }
+    onTextChanged(linesBefore);
+}
+
+void EditText::deleteBackward() {
+    if (cursor == 0) {
+        return;
+    }
+    size_t start = cursor - 1;
+    while (start > 0 && isUtf8Continuation(buffer.at(start))) {
+        start--;
+    }
+    erase(start, cursor - start);
+}
+
+void EditText::deleteForward() {
+    if (cursor >= buffer.size()) {
+        return;
+    }
+    size_t end = cursor + 1;
+    while (end < buffer.size() && isUtf8Continuation(buffer.at(end))) {
+        end++;
+    }
+    erase(cursor, end - cursor);
+}
+
+void EditText::setCursor(size_t pos) {
+    pos = std::min(pos, buffer.size());
+    // 光标只停在码点边界上
+    while (pos > 0 && pos < buffer.size() && isUtf8Continuation(buffer.at(pos))) {
+        pos--;
+    }
+    if (cursor != pos) {
+        cursor = pos;
+        invalidate();
+    }
+}
+
+void EditText::setTextSize(float size) {
+    textPaint.setTextSize(size);
+    textLayout.reset();
+    requestLayout();
+    invalidate();
+}
+
+void EditText::setTextColor(Color color) {
+    textPaint.setColor(color);
+    cursorPaint.setColor(color);
+    invalidate();
+}
+
+void EditText::onTextChanged(size_t linesBefore) {
+    // 行数不变时高度不变，只需重绘
+    if (!textLayout || textLayout->getLineCount() != linesBefore) {
+        requestLayout();
+    }
+    invalidate();
+}
+
+TextStyle EditText::getTextStyle() const {
+    TextStyle style;
+    style.size = static_cast<int>(textPaint.getTextSize());
+    style.color = textPaint.getColor();
+    return style;
+}
+
+EditableLayout* EditText::getLayout(IFontRenderer* renderer, int width) {
+    if (textLayout) {
+        textLayout->setMaxWidth(buffer, width);
+        return textLayout.get();
+    }
+    if (!renderer) {
+        return nullptr;
+    }
+    textLayout = std::make_unique<EditableLayout>(*renderer, getTextStyle(), width);
+    textLayout->reset(buffer);
+    return textLayout.get();
+}
+
+void EditText::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
+    // 宽度尽量占满，高度随行数变化
+    int width = MeasureSpec::getSize(widthMeasureSpec);
+    int availableWidth = std::max(1, width - paddingLeft - paddingRight);
+
+    float textHeight = IFontRenderer::FontMetrics::estimate(textPaint.getTextSize()).getLineHeight();
+    RenderContext* context = Application::getInstance().getRenderContext();
+    if (auto* layout = getLayout(context ? context->getFontRenderer() : nullptr, availableWidth)) {
+        textHeight = layout->getHeight();
+    }
+
+    int desiredHeight = static_cast<int>(std::ceil(textHeight)) + paddingTop + paddingBottom;
+    setMeasuredDimension(MeasureSpec::resolveSize(width, widthMeasureSpec),
+                         MeasureSpec::resolveSize(desiredHeight, heightMeasureSpec));
+}
+
+void EditText::onDraw(RenderContext& context) {
+    int availableWidth = std::max(1, bounds.width - paddingLeft - paddingRight);
+    EditableLayout* layout = getLayout(context.getFontRenderer(), availableWidth);
+    if (!layout) {
+        return;
+    }
+
+    float lineHeight = layout->getLineHeight();
+    float baselineOffset = layout->getBaselineOffset();
+    float top = static_cast<float>(bounds.y + paddingTop);
+    float left = static_cast<float>(bounds.x + paddingLeft);
+
+    context.save();
+    context.clipRect(bounds);
+
+    // 只绘制落在控件范围内的行
+    size_t visibleLines = static_cast<size_t>(std::ceil(bounds.height / lineHeight));
+    size_t lastLine = std::min(layout->getLineCount(), visibleLines);
+    for (size_t index = 0; index < layout->getParagraphCount(); index++) {
+        const auto& paragraph = layout->getParagraph(index);
+        if (paragraph.firstLine >= lastLine) {
+            break;
+        }
+        for (size_t i = 0; i < paragraph.lines.size() && paragraph.firstLine + i < lastLine; i++) {
+            const auto& line = paragraph.lines[i];
+            float baseline = top + (paragraph.firstLine + i) * lineHeight + baselineOffset;
+            context.drawText(buffer.substr(paragraph.start + line.start, line.end - line.start),
+                             left, baseline, textPaint);
+        }
+    }
+
+    // 光标
+    size_t cursorLine;
+    float cursorX;
+    layout->getCaretPosition(cursor, cursorLine, cursorX);
+    float cursorTop = top + cursorLine * lineHeight;
+    context.drawLine(left + cursorX, cursorTop, left + cursorX, cursorTop + lineHeight,
+                     cursorPaint);
+
+    context.restore();
+}
@@ -0,0 +1,222 @@
+#include "widgets/large_text_view.h"
+#include "view/measure_spec.h"
+#include "application/application.h"
+#include "core/logger.h"
+#include <algorithm>
+#include <cmath>
+
+LOG_TAG("LargeTextView");
+
+LargeTextView::LargeTextView() {
+    textPaint.setTextSize(14.0f);
+    textPaint.setColor(Color::Black());
+
+    // 后台索引线程通过UI线程的Handler通知重绘
+    if (Looper* looper = Looper::getCurrentThreadLooper()) {
+        uiHandler = std::make_unique<Handler>(looper);
+        document.setIndexListener([this]() {
+            // 合并多次通知，UI线程处理前只投递一次
+            if (!indexUpdatePending.exchange(true)) {
+                uiHandler->post([this]() { onIndexUpdated(); });
+            }
+        });
+    } else {
+        LOGE("No looper on current thread, index progress is only picked up on redraw");
+    }
+}
+
+LargeTextView::~LargeTextView() {
+    document.setIndexListener(nullptr);
+}
+
+void LargeTextView::setText(const std::string& text) {
+    document.clear();
+    document.append(text);
+    clearLineCache();
+    scrollY = 0;
+    pinnedToEnd = false;
+    requestLayout();
+    invalidate();
+}
+
+void LargeTextView::appendText(const std::string& text) {
+    document.append(text);
+    invalidate();
+}
+
+void LargeTextView::clear() {
+    document.clear();
+    clearLineCache();
+    scrollY = 0;
+    pinnedToEnd = true;
+    requestLayout();
+    invalidate();
+}
+
+void LargeTextView::setTextSize(float size) {
+    textPaint.setTextSize(size);
+    clearLineCache();
+    setScrollY(scrollY);
+    invalidate();
+}
+
+void LargeTextView::setTextColor(Color color) {
+    textPaint.setColor(color);
+    invalidate();
+}
+
+IFontRenderer::FontMetrics LargeTextView::getFontMetrics() const {
+    // 滚动计算不一定在绘制中，直接使用全局渲染上下文的字体渲染器
+    RenderContext* context = Application::getInstance().getRenderContext();
+    if (IFontRenderer* renderer = context ? context->getFontRenderer() : nullptr) {
+        return renderer->getFontMetrics(getTextStyle());
+    }
+    return IFontRenderer::FontMetrics::estimate(textPaint.getTextSize());
+}
+
+float LargeTextView::getLineHeight() const {
+    return getFontMetrics().getLineHeight();
+}
+
+float LargeTextView::getContentHeight() const {
+    return getLineHeight() * document.getLineCount();
+}
+
+float LargeTextView::getMaxScrollY() const {
+    float viewport = static_cast<float>(bounds.height - paddingTop - paddingBottom);
+    return std::max(0.0f, getContentHeight() - viewport);
+}
+
+void LargeTextView::setScrollY(float y) {
+    float maxScroll = getMaxScrollY();
+    scrollY = std::clamp(y, 0.0f, maxScroll);
+    pinnedToEnd = scrollY >= maxScroll;
+    invalidate();
+}
+
+void LargeTextView::scrollBy(float dy) {
+    setScrollY(scrollY + dy);
+}
+
+void LargeTextView::scrollToLine(size_t line) {
+    setScrollY(line * getLineHeight());
+}
+
+void LargeTextView::scrollToEnd() {
+    setScrollY(getMaxScrollY());
+}
+
+void LargeTextView::onIndexUpdated() {
+    indexUpdatePending = false;
+    if (followTail && pinnedToEnd) {
+        scrollY = getMaxScrollY();
+    }
+    invalidate();
+}
+
+TextStyle LargeTextView::getTextStyle() const {
+    TextStyle style;
+    style.size = static_cast<int>(textPaint.getTextSize());
+    style.color = textPaint.getColor();
+    return style;
+}
+
+void LargeTextView::clearLineCache() {
+    lineLru.clear();
+    lineIndex.clear();
+    cachedLineCount = 0;
+}
+
+std::shared_ptr<const ParagraphLayout> LargeTextView::getLineLayout(IFontRenderer& renderer,
+                                                                   size_t line) {
+    auto it = lineIndex.find(line);
+    if (it != lineIndex.end()) {
+        lineLru.splice(lineLru.begin(), lineLru, it->second);
+        return it->second->second;
+    }
+
+    // 不使用全局的ParagraphLayoutCache，避免日志行把其它控件的排版挤出缓存
+    auto layout = std::make_shared<const ParagraphLayout>(
+        renderer, document.getLine(line, kMaxLineBytes), getTextStyle(), 0,
+        ParagraphLayout::Options());
+
+    lineLru.emplace_front(line, layout);
+    lineIndex[line] = lineLru.begin();
+    if (lineLru.size() > kMaxCachedLines) {
+        lineIndex.erase(lineLru.back().first);
+        lineLru.pop_back();
+    }
+    return layout;
+}
+
+void LargeTextView::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
+    // 宽度尽量占满，高度按内容计算，通常由父布局限制
+    int desiredWidth = MeasureSpec::getSize(widthMeasureSpec);
+    int desiredHeight = static_cast<int>(std::ceil(getContentHeight())) +
+                        paddingTop + paddingBottom;
+
+    int width = MeasureSpec::resolveSize(desiredWidth, widthMeasureSpec);
+    int height = MeasureSpec::resolveSize(desiredHeight, heightMeasureSpec);
+    setMeasuredDimension(width, height);
+}
+
+void LargeTextView::onDraw(RenderContext& context) {
+    IFontRenderer* renderer = context.getFontRenderer();
+    if (!renderer) {
+        return;
+    }
+
+    // 最后一行可能随追加而变长，行数变化后丢弃它的缓存
+    size_t lineCount = document.getLineCount();
+    if (lineCount != cachedLineCount) {
+        if (cachedLineCount > 0) {
+            auto it = lineIndex.find(cachedLineCount - 1);
+            if (it != lineIndex.end()) {
+                lineLru.erase(it->second);
+                lineIndex.erase(it);
+            }
+        }
+        cachedLineCount = lineCount;
+    }
+    if (pinnedToEnd && followTail) {
+        scrollY = getMaxScrollY();
+    }
+
+    auto metrics = renderer->getFontMetrics(getTextStyle());
+    float lineHeight = metrics.getLineHeight();
+    int viewportTop = bounds.y + paddingTop;
+    int viewportHeight = bounds.height - paddingTop - paddingBottom;
+    if (viewportHeight <= 0 || lineHeight <= 0) {
+        return;
+    }
+
+    size_t firstVisible = static_cast<size_t>(scrollY / lineHeight);
+    size_t lastVisible = std::min(
+        lineCount, static_cast<size_t>((scrollY + viewportHeight) / lineHeight) + 1);
+
+    // 可见区域上下各预排版少量行，小幅滚动时直接命中缓存
+    size_t first = firstVisible > kVisibleMargin ? firstVisible - kVisibleMargin : 0;
+    size_t last = std::min(lineCount, lastVisible + kVisibleMargin);
+    for (size_t line = first; line < last; line++) {
+        if (line < firstVisible || line >= lastVisible) {
+            getLineLayout(*renderer, line);
+        }
+    }
+
+    context.save();
+    context.clipRect(Rect{bounds.x + paddingLeft, viewportTop,
+                          bounds.width - paddingLeft - paddingRight, viewportHeight});
+
+    float x = static_cast<float>(bounds.x + paddingLeft);
+    for (size_t line = firstVisible; line < lastVisible; line++) {
+        auto layout = getLineLayout(*renderer, line);
+        if (layout->getLineCount() == 0) {
+            continue;
+        }
+        float lineTop = viewportTop + line * lineHeight - scrollY;
+        float baseline = lineTop + metrics.getBaselineOffset();
+        context.drawText(layout->getLineText(0), x, baseline, textPaint);
+    }
+
+    context.restore();
+}
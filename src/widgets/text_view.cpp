@@ -1,6 +1,8 @@
 #include "widgets/text_view.h"
 #include "view/measure_spec.h"
+#include "application/application.h"
 #include "core/logger.h"
+#include <cmath>
 
 LOG_TAG("TextView");
 
@@ -14,6 +16,7 @@ TextView::TextView(const std::string& text) : text(text) {
 void TextView::setText(const std::string& text) {
     if (this->text != text) {
         this->text = text;
+        invalidateLayout();
         requestLayout();
         invalidate();
     }
@@ -21,11 +24,13 @@ void TextView::setText(const std::string& text) {
 
 void TextView::setTextSize(float size) {
     textPaint.setTextSize(size);
+    invalidateLayout();
     requestLayout();
     invalidate();
 }
 
 void TextView::setTextColor(Color color) {
+    // 颜色不影响排版，保留已有的排版结果
     textPaint.setColor(color);
     invalidate();
 }
@@ -35,40 +40,133 @@ void TextView::setTextAlignment(TextAlignment alignment) {
     invalidate();
 }
 
+void TextView::setMaxLines(int maxLines) {
+    if (layoutOptions.maxLines != maxLines) {
+        layoutOptions.maxLines = maxLines;
+        invalidateLayout();
+        requestLayout();
+        invalidate();
+    }
+}
+
+void TextView::setEllipsize(bool ellipsize) {
+    if (layoutOptions.ellipsize != ellipsize) {
+        layoutOptions.ellipsize = ellipsize;
+        invalidateLayout();
+        requestLayout();
+        invalidate();
+    }
+}
+
+void TextView::setBreakStrategy(ParagraphLayout::BreakStrategy strategy) {
+    if (layoutOptions.breakStrategy != strategy) {
+        layoutOptions.breakStrategy = strategy;
+        invalidateLayout();
+        requestLayout();
+        invalidate();
+    }
+}
+
+TextStyle TextView::getTextStyle() const {
+    // 与RenderContext::drawText的转换保持一致
+    TextStyle style;
+    style.size = static_cast<int>(textPaint.getTextSize());
+    style.color = textPaint.getColor();
+    return style;
+}
+
+void TextView::invalidateLayout() {
+    textLayout.reset();
+    blobLayout.reset();
+    lineBlobs.clear();
+}
+
+const TextBlob* TextView::getLineBlob(IFontRenderer& renderer,
+                                      const std::shared_ptr<const ParagraphLayout>& layout,
+                                      size_t line) {
+    // 宽度变化会换成另一个排版对象，此时丢弃旧的blob
+    if (blobLayout != layout) {
+        blobLayout = layout;
+        lineBlobs.assign(layout->getLineCount(), nullptr);
+    }
+    auto& blob = lineBlobs[line];
+    if (!blob) {
+        blob = renderer.makeTextBlob(layout->getLineText(line), getTextStyle());
+    }
+    return blob.get();
+}
+
+std::shared_ptr<const ParagraphLayout> TextView::getLayout(IFontRenderer* renderer, int width) {
+    if (textLayout && textLayout->isValidForWidth(width)) {
+        return textLayout;
+    }
+    if (!renderer) {
+        return nullptr;
+    }
+
+    textLayout = ParagraphLayoutCache::getInstance().get(
+        *renderer, text, getTextStyle(), width, layoutOptions);
+    return textLayout;
+}
+
 void TextView::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
-    // 计算文本尺寸
-    float textWidth = textPaint.measureText(text);
-    float textHeight = textPaint.getTextHeight();
-    
-    // 文本实际占用的高度约为 1.2 倍的字体高度
-    float actualTextHeight = textHeight * 1.2f;
-    
+    // 可用宽度，UNSPECIFIED时不自动折行
+    int availableWidth = 0;
+    if (MeasureSpec::getMode(widthMeasureSpec) != MeasureSpec::UNSPECIFIED) {
+        availableWidth = std::max(1, MeasureSpec::getSize(widthMeasureSpec) -
+                                     paddingLeft - paddingRight);
+    }
+
+    float textWidth;
+    float textHeight;
+    RenderContext* context = Application::getInstance().getRenderContext();
+    auto layout = getLayout(context ? context->getFontRenderer() : nullptr, availableWidth);
+    if (layout) {
+        textWidth = std::ceil(layout->getWidth());
+        textHeight = layout->getHeight();
+    } else {
+        // 没有字体渲染器时退回到估算值
+        textWidth = textPaint.measureText(text);
+        textHeight = IFontRenderer::FontMetrics::estimate(textPaint.getTextSize()).getLineHeight();
+    }
+
     // 考虑padding
     int desiredWidth = static_cast<int>(textWidth + paddingLeft + paddingRight);
-    int desiredHeight = static_cast<int>(actualTextHeight + paddingTop + paddingBottom);
-    
+    int desiredHeight = static_cast<int>(std::ceil(textHeight) + paddingTop + paddingBottom);
+
     // 根据MeasureSpec调整最终尺寸
     int width = MeasureSpec::resolveSize(desiredWidth, widthMeasureSpec);
     int height = MeasureSpec::resolveSize(desiredHeight, heightMeasureSpec);
-    
+
     setMeasuredDimension(width, height);
 }
 
 void TextView::onDraw(RenderContext& context) {
-    // 计算文本位置
-    float textWidth = textPaint.measureText(text);
-    float textHeight = textPaint.getTextHeight();
-    
-    // 计算文本垂直居中的基线位置
-    // 文本基线应该在中心偏下textHeight/2的位置
-    float textBaseline = bounds.y + (bounds.height + textHeight) / 2.0f - textHeight * 0.1f;
-    
-    // 根据对齐方式调整x坐标
-    float x = bounds.x + paddingLeft;
-    if (textAlignment == TextAlignment::Center) {
-        x = bounds.x + (bounds.width - textWidth) / 2;
+    int availableWidth = std::max(1, bounds.width - paddingLeft - paddingRight);
+    auto layout = getLayout(context.getFontRenderer(), availableWidth);
+    if (!layout) {
+        return;
+    }
+
+    float lineHeight = layout->getLineHeight();
+
+    // 整个文本块垂直居中，基线位置取自字体的上升高度
+    float blockTop = bounds.y + (bounds.height - layout->getHeight()) / 2.0f;
+    float baseline = blockTop + layout->getBaselineOffset();
+
+    for (size_t i = 0; i < layout->getLineCount(); i++) {
+        float lineWidth = layout->getLines()[i].width;
+
+        // 根据对齐方式调整x坐标
+        float x = bounds.x + paddingLeft;
+        if (textAlignment == TextAlignment::Center) {
+            x = bounds.x + (bounds.width - lineWidth) / 2;
+        } else if (textAlignment == TextAlignment::Right) {
+            x = bounds.x + bounds.width - paddingRight - lineWidth;
+        }
+
+        context.drawTextBlob(*getLineBlob(*context.getFontRenderer(), layout, i),
+                             x, baseline, textPaint);
+        baseline += lineHeight;
     }
-    
-    // 绘制文本
-    context.drawText(text, x, textBaseline, textPaint);
-} 
\ No newline at end of file
+}